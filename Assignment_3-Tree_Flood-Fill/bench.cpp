@@ -0,0 +1,222 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include "functions.h"
+
+// Allocation tracking: every global new/delete goes through these counters,
+// each block carries its size in a header so live bytes can be tracked.
+// They are kept out of line, inlined into the containers GCC mistakes the
+// header arithmetic for out of bounds accesses
+
+namespace
+{
+    const std::size_t HEADER = sizeof(std::max_align_t);
+
+    std::size_t allocations = 0;
+    std::size_t liveBytes = 0;
+    std::size_t peakBytes = 0;
+}
+
+[[gnu::noinline]] void* operator new(std::size_t size)
+{
+    void* block = std::malloc(size + HEADER);
+    if (!block)
+        throw std::bad_alloc();
+
+    *static_cast<std::size_t*>(block) = size;
+    ++allocations;
+    liveBytes += size;
+    if (liveBytes > peakBytes)
+        peakBytes = liveBytes;
+
+    return static_cast<char*>(block) + HEADER;
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+    if (!p)
+        return;
+
+    char* block = static_cast<char*>(p) - HEADER;
+    liveBytes -= *reinterpret_cast<std::size_t*>(block);
+    std::free(block);
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+// Tree generators, every non-root node is "x" with probability fraction
+
+enum class Topology { Balanced, Skewed, Star, Random };
+
+const char* name(Topology topology)
+{
+    switch (topology)
+    {
+    case Topology::Balanced: return "balanced";
+    case Topology::Skewed:   return "skewed";
+    case Topology::Star:     return "star";
+    default:                 return "random";
+    }
+}
+
+AI::TreeNode* build(Topology topology, int count, double fraction, std::mt19937& rng)
+{
+    std::bernoulli_distribution isX(fraction);
+    std::vector<AI::TreeNode*> nodes;
+    nodes.reserve(count);
+    nodes.push_back(new AI::TreeNode("root"));
+
+    for (int i = 1; i < count; ++i)
+    {
+        int parent = 0;
+        switch (topology)
+        {
+        case Topology::Balanced:
+            parent = (i - 1) / 2;
+            break;
+        case Topology::Skewed:
+            // A caterpillar: odd nodes form the spine, even nodes are leaves
+            parent = i == 1 ? 0 : (i % 2 ? i - 2 : i - 1);
+            break;
+        case Topology::Star:
+            parent = 0;
+            break;
+        case Topology::Random:
+            parent = std::uniform_int_distribution<int>(0, i - 1)(rng);
+            break;
+        }
+
+        AI::TreeNode* node = new AI::TreeNode(isX(rng) ? "x" : "a", nodes[parent]);
+        nodes[parent]->children.push_back(node);
+        nodes.push_back(node);
+    }
+    return nodes.front();
+}
+
+struct Result
+{
+    double seconds;
+    std::size_t filled;
+    std::size_t allocations;
+    std::size_t peakBytes;
+};
+
+// Times fills on the tree, the journal puts the tree back between repeats.
+// It must have room for every node already, so its growth is not counted
+// against the engine measured first
+template<typename Engine>
+Result measure(Engine& engine, AI::Journal& journal, AI::TreeNode* tree, int repeats)
+{
+    Result result{ 0.0, 0, 0, 0 };
+
+    for (int r = 0; r < repeats; ++r)
+    {
+        std::size_t baseAllocations = allocations;
+        std::size_t baseBytes = liveBytes;
+        peakBytes = liveBytes;
+
+        auto start = std::chrono::steady_clock::now();
+        engine.run(tree, "z");
+        auto stop = std::chrono::steady_clock::now();
+
+        result.seconds += std::chrono::duration<double>(stop - start).count();
+        result.allocations += allocations - baseAllocations;
+        if (peakBytes - baseBytes > result.peakBytes)
+            result.peakBytes = peakBytes - baseBytes;
+        result.filled = journal.size();
+
+        journal.rollback();
+    }
+    result.allocations /= repeats;
+    return result;
+}
+
+void report(Topology topology, const char* engine, int count, const Result& result, int repeats)
+{
+    double perRun = result.seconds / repeats;
+
+    std::cout << std::left << std::setw(10) << name(topology)
+              << std::setw(24) << engine
+              << std::right << std::setw(10) << count
+              << std::setw(10) << result.filled
+              << std::setw(12) << std::fixed << std::setprecision(2)
+              << (perRun > 0.0 ? result.filled / perRun / 1e6 : 0.0)
+              << std::setw(10) << result.allocations
+              << std::setw(12) << std::setprecision(1) << result.peakBytes / 1024.0
+              << std::endl;
+}
+
+// Usage: bench.out [nodes] [x-fraction] [repeats]
+int main(int argc, char* argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 1 << 15;
+    double fraction = argc > 2 ? std::atof(argv[2]) : 0.9;
+    int repeats = argc > 3 ? std::atoi(argv[3]) : 5;
+
+    if (count < 1 || repeats < 1 || fraction < 0.0 || fraction > 1.0)
+    {
+        std::cout << "Usage: bench.out [nodes] [x-fraction] [repeats]" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(10) << "topology"
+              << std::setw(24) << "engine"
+              << std::right << std::setw(10) << "nodes"
+              << std::setw(10) << "filled"
+              << std::setw(12) << "Mnodes/s"
+              << std::setw(10) << "allocs"
+              << std::setw(12) << "peak KiB"
+              << std::endl;
+
+    std::mt19937 rng(2022);
+
+    for (Topology topology : { Topology::Balanced, Topology::Skewed, Topology::Star, Topology::Random })
+    {
+        AI::TreeNode* tree = build(topology, count, fraction, rng);
+
+        AI::GetTreeAdjacents getAdjacents;
+        AI::GetTreeStochasticAdjacents getStochasticAdjacents;
+        AI::Journal journal;
+        journal.reserve(count);
+
+        AI::Flood_Fill_Recursive recursive(&getAdjacents, &journal);
+        report(topology, "Recursive", count, measure(recursive, journal, tree, repeats), repeats);
+
+        AI::Flood_Fill_Iterative<AI::Queue> queue(&getAdjacents, &journal);
+        report(topology, "Iterative<Queue>", count, measure(queue, journal, tree, repeats), repeats);
+
+        AI::Flood_Fill_Iterative<AI::Stack> stack(&getAdjacents, &journal);
+        report(topology, "Iterative<Stack>", count, measure(stack, journal, tree, repeats), repeats);
+
+        AI::Flood_Fill_Recursive stochastic(&getStochasticAdjacents, &journal);
+        report(topology, "Recursive stochastic", count, measure(stochastic, journal, tree, repeats), repeats);
+
+        delete tree;
+    }
+
+    return 0;
+}
@@ -140,6 +140,89 @@ namespace AI
 	// The actual node type for this assignment
 	using TreeNode = Node<std::string>;
 
+	// Change journal that records the old value of every node a fill
+	// overwrites, so the fill can be rolled back in O(changed nodes)
+	class Journal
+	{
+		struct Entry
+		{
+			TreeNode* pNode;
+			std::string value;
+		};
+
+		std::vector<Entry> entries;
+
+	public:
+
+		/**
+		 * @brief
+		 * Forget all recorded changes. The buffer keeps its capacity
+		 so the next fill does not reallocate.
+		*/
+		void clear()
+		{
+			entries.clear();
+		}
+
+		/**
+		 * @brief
+		 * Make room for a number of changes up front, so recording them
+		 does not reallocate.
+		 * @param count
+		 * number of changes, at most the number of nodes of the tree
+		*/
+		void reserve( size_t count )
+		{
+			entries.reserve( count );
+		}
+
+		/**
+		 * @brief
+		 * Save the current value of a node before it is overwritten.
+		 The value is moved out, so the caller must assign a new one.
+		 * @param pNode
+		 * node that is about to change
+		*/
+		void record( TreeNode* pNode )
+		{
+			entries.push_back( { pNode, std::move( pNode->value ) } );
+		}
+
+		/**
+		 * @brief
+		 * Restore every recorded node to its old value, newest first,
+		 and leave the journal empty.
+		*/
+		void rollback()
+		{
+			for ( auto it = entries.rbegin(); it != entries.rend(); ++it )
+				it->pNode->value = std::move( it->value );
+			entries.clear();
+		}
+
+		/**
+		 * @brief
+		 * Number of recorded changes
+		 * @return
+		 * count of nodes changed since the last clear or rollback
+		*/
+		size_t size() const
+		{
+			return entries.size();
+		}
+
+		/**
+		 * @brief
+		 * Test whether there is anything to roll back
+		 * @return
+		 * Returns whether no changes are recorded
+		*/
+		bool empty() const
+		{
+			return entries.empty();
+		}
+	};
+
 	// Abstract base class for domain specific functors that return adjacent nodes
 	class GetAdjacents
 	{
@@ -327,6 +410,7 @@ namespace AI
 	class Flood_Fill_Recursive
 	{
 		GetTreeAdjacents* pGetAdjacents;
+		Journal* pJournal;
 
 	public:
 		/**
@@ -334,10 +418,12 @@ namespace AI
 		 * constructor
 		 * @param pGetAdjacents
 		 * get pointer to adjacent nodes
-		 *
+		 * @param pJournal
+		 * optional journal that records the changes of each fill
 		*/
-		Flood_Fill_Recursive( GetTreeAdjacents* pGetAdjacents )
-			: pGetAdjacents{ pGetAdjacents }
+		Flood_Fill_Recursive( GetTreeAdjacents* pGetAdjacents,
+							  Journal* pJournal = nullptr )
+			: pGetAdjacents{ pGetAdjacents }, pJournal{ pJournal }
 		{}
 
 		/**
@@ -349,6 +435,23 @@ namespace AI
 		 * velue to be replaced or filled
 		*/
 		void run( TreeNode* pNode, std::string value )
+		{
+			if ( pJournal )
+				pJournal->clear();
+			fill( pNode, value );
+		}
+
+	private:
+
+		/**
+		 * @brief
+		 * fill the adjacents of a node and recurse into them
+		 * @param pNode
+		 * node whose adjacents are filled
+		 * @param value
+		 * velue to be replaced or filled
+		*/
+		void fill( TreeNode* pNode, const std::string& value )
 		{
 			// Implement the flood fill
 			std::vector<TreeNode*> list = pGetAdjacents->operator()( pNode );
@@ -358,8 +461,10 @@ namespace AI
 				if ( adjacent_nodes->value != value )
 				{
 					// change the colour for the adjacents nodes
+					if ( pJournal )
+						pJournal->record( adjacent_nodes );
 					adjacent_nodes->value = value;
-					run( adjacent_nodes, value );
+					fill( adjacent_nodes, value );
 				}
 			}
 		}
@@ -371,6 +476,7 @@ namespace AI
 	class Flood_Fill_Iterative
 	{
 		GetTreeAdjacents* pGetAdjacents;
+		Journal* pJournal;
 		T openlist;
 
 	public:
@@ -379,10 +485,12 @@ namespace AI
 		 * constructor
 		 * @param pGetAdjacents
 		 * get pointer to adjacent nodes
-		 *
+		 * @param pJournal
+		 * optional journal that records the changes of each fill
 		*/
-		Flood_Fill_Iterative( GetTreeAdjacents* pGetAdjacents )
-			: pGetAdjacents{ pGetAdjacents }, openlist{}
+		Flood_Fill_Iterative( GetTreeAdjacents* pGetAdjacents,
+							  Journal* pJournal = nullptr )
+			: pGetAdjacents{ pGetAdjacents }, pJournal{ pJournal }, openlist{}
 		{
 		}
 
@@ -397,11 +505,15 @@ namespace AI
 		void run( TreeNode* pNode, std::string value )
 		{
 			openlist.clear();
+			if ( pJournal )
+				pJournal->clear();
 			std::vector<TreeNode*> list = pGetAdjacents->operator()( pNode );
 			for ( auto& child : list )
 			{
 				if ( child->value != value )
 				{
+					if ( pJournal )
+						pJournal->record( child );
 					child->value = value;
 					openlist.push( child );
 				}
@@ -417,6 +529,8 @@ namespace AI
 				{
 					if ( adjacent_nodes->value != value )
 					{
+						if ( pJournal )
+							pJournal->record( adjacent_nodes );
 						adjacent_nodes->value = value;
 						openlist.push( adjacent_nodes );
 					}
@@ -15,10 +15,11 @@ void test7();
 void test8();
 void test9();
 void test10();
+void test11();
 
 int main(int argc, char* argv[])
 {
-    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10 };
+    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10, test11 };
     const int SIZE = sizeof(f) / sizeof(f[0]);
     int id = -1;
 
@@ -367,3 +368,43 @@ a {3\
     else
         std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
 }
+
+// Fill and then roll the journal back to the original tree
+
+void test11()
+{
+    std::istringstream istream{"\
+a {3\
+ x {1 x {0 } }\
+ x {2 aba {0 } x {0 } }\
+ ac {0 } } "};
+
+    AI::TreeNode tree;
+
+    istream >> tree;
+
+    std::ostringstream before;
+    before << tree;
+
+    AI::GetTreeAdjacents getAdjacents;
+    AI::Journal journal;
+
+    AI::Flood_Fill_Iterative<AI::Stack>(&getAdjacents, &journal).run(&tree, "z");
+
+    std::ostringstream filled;
+    filled << tree << journal.size();
+
+    journal.rollback();
+
+    std::ostringstream os;
+    os << filled.str() << "|" << tree;
+
+    std::string actual = os.str();
+    std::string expected = "a {3 z {1 z {0 } } z {2 aba {0 } z {0 } } ac {0 } } 4|" + before.str();
+
+    std::cout << "Test 11 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
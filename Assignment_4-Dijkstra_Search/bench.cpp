@@ -0,0 +1,556 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include "functions.h"
+
+// Allocation tracking: every global new/delete goes through these counters,
+// each block carries its size in a header so live bytes can be tracked.
+// They are kept out of line, inlined into the containers GCC mistakes the
+// header arithmetic for out of bounds accesses
+
+namespace
+{
+    const std::size_t HEADER = sizeof(std::max_align_t);
+
+    std::size_t allocations = 0;
+    std::size_t liveBytes = 0;
+    std::size_t peakBytes = 0;
+}
+
+[[gnu::noinline]] void* operator new(std::size_t size)
+{
+    void* block = std::malloc(size + HEADER);
+    if (!block)
+        throw std::bad_alloc();
+
+    *static_cast<std::size_t*>(block) = size;
+    ++allocations;
+    liveBytes += size;
+    if (liveBytes > peakBytes)
+        peakBytes = liveBytes;
+
+    return static_cast<char*>(block) + HEADER;
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+    if (!p)
+        return;
+
+    char* block = static_cast<char*>(p) - HEADER;
+    liveBytes -= *reinterpret_cast<std::size_t*>(block);
+    std::free(block);
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+// A square map in the format of GetMapAdjacents: 0 empty, 1 wall
+
+struct Grid
+{
+    std::string name;
+    int size;
+    std::vector<int> cells;
+
+    bool open(int j, int i) const
+    {
+        return j >= 0 && j < size && i >= 0 && i < size && cells[j * size + i] != 1;
+    }
+};
+
+Grid randomGrid(int size, double density, std::mt19937& rng)
+{
+    std::ostringstream name;
+    name << "random" << static_cast<int>(density * 100 + 0.5) << '%';
+    Grid grid{ name.str(), size, std::vector<int>(static_cast<size_t>(size) * size, 0) };
+
+    std::bernoulli_distribution wall(density);
+    for (int& cell : grid.cells)
+        cell = wall(rng) ? 1 : 0;
+    return grid;
+}
+
+// Rooms of random size in a lattice of 16x16 blocks, each room joined to
+// the rooms right of and below it by an L-shaped corridor
+Grid roomsGrid(int size, std::mt19937& rng)
+{
+    const int BLOCK = 16;
+    Grid grid{ "rooms", size, std::vector<int>(static_cast<size_t>(size) * size, 1) };
+    int blocks = size / BLOCK;
+    std::vector<AI::Key> centres;
+
+    auto carve = [&grid](int j, int i) { grid.cells[j * grid.size + i] = 0; };
+    auto pick = [&rng](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+
+    for (int bj = 0; bj < blocks; ++bj)
+    {
+        for (int bi = 0; bi < blocks; ++bi)
+        {
+            int height = pick(4, BLOCK - 2);
+            int width = pick(4, BLOCK - 2);
+            int top = bj * BLOCK + 1 + pick(0, BLOCK - 2 - height);
+            int left = bi * BLOCK + 1 + pick(0, BLOCK - 2 - width);
+            for (int j = top; j < top + height; ++j)
+                for (int i = left; i < left + width; ++i)
+                    carve(j, i);
+            centres.push_back({ top + height / 2, left + width / 2 });
+        }
+    }
+
+    auto corridor = [&carve](AI::Key from, AI::Key to)
+    {
+        for (int i = std::min(from.i, to.i); i <= std::max(from.i, to.i); ++i)
+            carve(from.j, i);
+        for (int j = std::min(from.j, to.j); j <= std::max(from.j, to.j); ++j)
+            carve(j, to.i);
+    };
+
+    for (int bj = 0; bj < blocks; ++bj)
+    {
+        for (int bi = 0; bi < blocks; ++bi)
+        {
+            if (bi + 1 < blocks)
+                corridor(centres[bj * blocks + bi], centres[bj * blocks + bi + 1]);
+            if (bj + 1 < blocks)
+                corridor(centres[bj * blocks + bi], centres[(bj + 1) * blocks + bi]);
+        }
+    }
+    return grid;
+}
+
+// Perfect maze carved by a depth-first backtracker over the odd cells
+Grid mazeGrid(int size, std::mt19937& rng)
+{
+    Grid grid{ "maze", size, std::vector<int>(static_cast<size_t>(size) * size, 1) };
+    const int dj[4] = { 0, 0, -2, 2 };
+    const int di[4] = { -2, 2, 0, 0 };
+
+    std::vector<AI::Key> stack{ { 1, 1 } };
+    grid.cells[size + 1] = 0;
+    while (!stack.empty())
+    {
+        AI::Key cell = stack.back();
+        int options[4];
+        int count = 0;
+        for (int d = 0; d < 4; ++d)
+        {
+            int j = cell.j + dj[d], i = cell.i + di[d];
+            if (j > 0 && j < size - 1 && i > 0 && i < size - 1 && grid.cells[j * size + i] == 1)
+                options[count++] = d;
+        }
+        if (!count)
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        int d = options[std::uniform_int_distribution<int>(0, count - 1)(rng)];
+        grid.cells[(cell.j + dj[d] / 2) * size + cell.i + di[d] / 2] = 0;
+        grid.cells[(cell.j + dj[d]) * size + cell.i + di[d]] = 0;
+        stack.push_back({ cell.j + dj[d], cell.i + di[d] });
+    }
+    return grid;
+}
+
+// Reads a map of the Moving AI benchmark sets (.map): a header with height
+// and width, then one row per line where '.', 'G' and 'S' are passable.
+// Maps that are not square are padded with walls. Sides over 4096 are
+// refused, well within the 32767 cells a Key can address
+bool loadGrid(const std::string& path, Grid& grid)
+{
+    std::ifstream file(path);
+    std::string word;
+    int height = 0, width = 0;
+    while (file >> word && word != "map")
+    {
+        if (word == "height")
+            file >> height;
+        else if (word == "width")
+            file >> width;
+    }
+    if (!file || height <= 0 || width <= 0 || std::max(height, width) > 4096)
+        return false;
+
+    grid.name = path.substr(path.find_last_of("/\\") + 1);
+    grid.size = std::max(height, width);
+    grid.cells.assign(static_cast<size_t>(grid.size) * grid.size, 1);
+    for (int j = 0; j < height && file >> word; ++j)
+        for (int i = 0; i < width && i < static_cast<int>(word.size()); ++i)
+            if (word[i] == '.' || word[i] == 'G' || word[i] == 'S')
+                grid.cells[j * grid.size + i] = 0;
+    return true;
+}
+
+// Reference costs from a plain breadth-first search, every move costs 10
+// on these maps so the first visit of a cell is its shortest distance
+std::vector<int> reference(const Grid& grid, AI::Key start)
+{
+    const int dj[4] = { 0, 0, -1, 1 };
+    const int di[4] = { -1, 1, 0, 0 };
+    std::vector<int> distance(grid.cells.size(), -1);
+    std::vector<AI::Key> frontier{ start };
+    distance[start.j * grid.size + start.i] = 0;
+
+    for (size_t k = 0; k < frontier.size(); ++k)
+    {
+        AI::Key cell = frontier[k];
+        int d = distance[cell.j * grid.size + cell.i] + 10;
+        for (int n = 0; n < 4; ++n)
+        {
+            int j = cell.j + dj[n], i = cell.i + di[n];
+            if (grid.open(j, i) && distance[j * grid.size + i] < 0)
+            {
+                distance[j * grid.size + i] = d;
+                frontier.push_back({ j, i });
+            }
+        }
+    }
+    return distance;
+}
+
+struct Query
+{
+    AI::Key start;
+    AI::Key goal;
+    int cost;
+};
+
+// Start and goal pairs drawn from the largest connected region of the map
+std::vector<Query> queries(const Grid& grid, int count, std::mt19937& rng)
+{
+    const int dj[4] = { 0, 0, -1, 1 };
+    const int di[4] = { -1, 1, 0, 0 };
+    std::vector<int> region(grid.cells.size(), -1);
+    std::vector<int> frontier;
+    int best = -1;
+    size_t bestSize = 0;
+    for (int k = 0; k < static_cast<int>(grid.cells.size()); ++k)
+    {
+        if (grid.cells[k] == 1 || region[k] >= 0)
+            continue;
+
+        frontier.assign(1, k);
+        region[k] = k;
+        for (size_t f = 0; f < frontier.size(); ++f)
+        {
+            int j = frontier[f] / grid.size, i = frontier[f] % grid.size;
+            for (int n = 0; n < 4; ++n)
+            {
+                int c = (j + dj[n]) * grid.size + i + di[n];
+                if (grid.open(j + dj[n], i + di[n]) && region[c] < 0)
+                {
+                    region[c] = k;
+                    frontier.push_back(c);
+                }
+            }
+        }
+        if (frontier.size() > bestSize)
+        {
+            best = k;
+            bestSize = frontier.size();
+        }
+    }
+
+    std::vector<int> cells;
+    for (int k = 0; k < static_cast<int>(region.size()); ++k)
+        if (region[k] == best)
+            cells.push_back(k);
+
+    std::vector<Query> result;
+    if (cells.size() < 2)
+        return result;
+
+    std::uniform_int_distribution<size_t> any(0, cells.size() - 1);
+    for (int q = 0; q < count; ++q)
+    {
+        int s = cells[any(rng)], g = cells[any(rng)];
+        AI::Key start{ s / grid.size, s % grid.size };
+        AI::Key goal{ g / grid.size, g % grid.size };
+        result.push_back({ start, goal, reference(grid, start)[g] });
+    }
+    return result;
+}
+
+// Cost of a list of moves, -1 when it leaves the map, hits a wall or does
+// not end on the goal
+int cost(const Grid& grid, const Query& query, const std::vector<char>& moves)
+{
+    int j = query.start.j, i = query.start.i, total = 0;
+    for (char move : moves)
+    {
+        switch (move)
+        {
+        case 'N': --j; break;
+        case 'S': ++j; break;
+        case 'W': --i; break;
+        case 'E': ++i; break;
+        default: return -1;
+        }
+        if (!grid.open(j, i))
+            return -1;
+        total += 10;
+    }
+    return AI::Key(j, i) == query.goal ? total : -1;
+}
+
+// Work of one query as an engine counts it, -1 for what it does not count
+struct Counts
+{
+    long long expanded;
+    long long heapOps; // pushes and pops of the open list
+};
+
+Counts countsOf(const AI::SearchStats& stats)
+{
+    return { static_cast<long long>(stats.expanded), static_cast<long long>(stats.pushes + stats.pops) };
+}
+
+struct Result
+{
+    double mean;         // seconds per query
+    double p99;          // seconds, 99th percentile
+    double expanded;     // per query, -1 when the engine does not count
+    double heapOps;      // open list pushes and pops per query, -1 likewise
+    std::size_t peakBytes;
+    int wrong;           // paths invalid or not of the reference cost
+    double excess;       // mean cost above the reference, for approximations
+};
+
+// Runs every query through one engine. query(start, goal) returns the
+// moves, counted() the counts of the last query
+template<typename Run, typename Counted>
+Result measure(const Grid& grid, const std::vector<Query>& list, Run query, Counted counted)
+{
+    Result result{ 0.0, 0.0, 0.0, 0.0, 0, 0, 0.0 };
+    std::vector<double> seconds;
+    seconds.reserve(list.size());
+
+    for (const Query& q : list)
+    {
+        std::size_t baseBytes = liveBytes;
+        peakBytes = liveBytes;
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<char> moves = query(q.start, q.goal);
+        auto stop = std::chrono::steady_clock::now();
+
+        seconds.push_back(std::chrono::duration<double>(stop - start).count());
+        if (peakBytes - baseBytes > result.peakBytes)
+            result.peakBytes = peakBytes - baseBytes;
+        Counts counts = counted();
+        result.expanded = counts.expanded < 0 || result.expanded < 0 ? -1.0 : result.expanded + counts.expanded;
+        result.heapOps = counts.heapOps < 0 || result.heapOps < 0 ? -1.0 : result.heapOps + counts.heapOps;
+
+        int c = cost(grid, q, moves);
+        if (c != q.cost)
+            ++result.wrong;
+        if (c > 0 && q.cost > 0)
+            result.excess += static_cast<double>(c - q.cost) / q.cost;
+    }
+
+    for (double s : seconds)
+        result.mean += s;
+    result.mean /= list.size();
+    std::sort(seconds.begin(), seconds.end());
+    result.p99 = seconds[(seconds.size() * 99 + 99) / 100 - 1];
+    if (result.expanded > 0)
+        result.expanded /= list.size();
+    if (result.heapOps > 0)
+        result.heapOps /= list.size();
+    result.excess /= list.size();
+    return result;
+}
+
+void report(const Grid& grid, const char* engine, const Result& result, bool exact)
+{
+    std::cout << std::left << std::setw(14) << grid.name
+              << std::right << std::setw(6) << grid.size << "  "
+              << std::left << std::setw(22) << engine
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(11) << result.mean * 1e3
+              << std::setw(11) << result.p99 * 1e3
+              << std::setprecision(0) << std::setw(12);
+    if (result.expanded < 0)
+        std::cout << '-';
+    else
+        std::cout << result.expanded;
+    std::cout << std::setw(12);
+    if (result.heapOps < 0)
+        std::cout << '-';
+    else
+        std::cout << result.heapOps;
+    std::cout << std::setprecision(1) << std::setw(12) << result.peakBytes / 1024.0 << "  ";
+    if (exact)
+        std::cout << (result.wrong ? std::to_string(result.wrong) + " wrong" : "ok");
+    else
+        std::cout << '+' << std::setprecision(2) << result.excess * 100 << '%';
+    std::cout << std::endl;
+}
+
+// Moves between neighbouring cells from the node ids of a graph path
+std::vector<char> moves(int size, int start, const std::vector<int>& path)
+{
+    std::vector<char> result;
+    result.reserve(path.size());
+    for (int id : path)
+    {
+        int d = id - start;
+        result.push_back(d == 1 ? 'E' : d == -1 ? 'W' : d == size ? 'S' : 'N');
+        start = id;
+    }
+    return result;
+}
+
+AI::Graph graphOf(const Grid& grid)
+{
+    const int dj[4] = { 0, 0, -1, 1 };
+    const int di[4] = { -1, 1, 0, 0 };
+    std::vector<std::array<int, 3>> edges;
+    for (int j = 0; j < grid.size; ++j)
+        for (int i = 0; i < grid.size; ++i)
+            if (grid.open(j, i))
+                for (int d = 0; d < 4; ++d)
+                    if (grid.open(j + dj[d], i + di[d]))
+                        edges.push_back({ j * grid.size + i, (j + dj[d]) * grid.size + i + di[d], 10 });
+    return AI::Graph::fromEdges(grid.size * grid.size, edges);
+}
+
+void bench(Grid& grid, int count, std::mt19937& rng)
+{
+    std::vector<Query> list = queries(grid, count, rng);
+    if (list.empty())
+    {
+        std::cout << grid.name << ": no open region" << std::endl;
+        return;
+    }
+
+    AI::GetMapAdjacents getAdjacents{ grid.cells.data(), grid.size };
+
+    AI::Dijkstras dijkstras(&getAdjacents);
+    report(grid, "Dijkstras", measure(grid, list,
+        [&](AI::Key s, AI::Key g) { return dijkstras.run(s, g); },
+        [&]() { return countsOf(dijkstras.stats()); }), true);
+
+    AI::AStar<AI::Manhattan> astar(&getAdjacents);
+    report(grid, "AStar<Manhattan>", measure(grid, list,
+        [&](AI::Key s, AI::Key g) { return astar.run(s, g); },
+        [&]() { return countsOf(astar.stats()); }), true);
+
+    AI::Dial<AI::Manhattan> dial(&getAdjacents);
+    report(grid, "Dial<Manhattan>", measure(grid, list,
+        [&](AI::Key s, AI::Key g) { return dial.run(s, g); },
+        [&]() { return countsOf(dial.stats()); }), true);
+
+    AI::BidirectionalDijkstras bidirectional(&getAdjacents);
+    report(grid, "Bidirectional", measure(grid, list,
+        [&](AI::Key s, AI::Key g) { return bidirectional.run(s, g); },
+        [&]() { return countsOf(bidirectional.stats()); }), true);
+
+    AI::JumpPointSearch jps(&getAdjacents);
+    report(grid, "JumpPointSearch", measure(grid, list,
+        [&](AI::Key s, AI::Key g) { return jps.run(s, g); },
+        [&]() { return countsOf(jps.stats()); }), true);
+
+    AI::JumpPointSearchPlus jpsPlus(&getAdjacents);
+    report(grid, "JumpPointSearchPlus", measure(grid, list,
+        [&](AI::Key s, AI::Key g) { return jpsPlus.run(s, g); },
+        [&]() { return countsOf(jpsPlus.stats()); }), true);
+
+    // D* Lite counts expansions only, its queue is not instrumented
+    AI::DStarLite<AI::Manhattan> dstar(&getAdjacents);
+    report(grid, "DStarLite<Manhattan>", measure(grid, list,
+        [&](AI::Key s, AI::Key g) { return dstar.run(s, g); },
+        [&]() { return Counts{ static_cast<long long>(dstar.expansions()), -1 }; }), true);
+
+    AI::Graph graph = graphOf(grid);
+    AI::GraphDijkstras graphDijkstras(&graph);
+    report(grid, "GraphDijkstras", measure(grid, list,
+        [&](AI::Key s, AI::Key g)
+        {
+            int start = s.j * grid.size + s.i;
+            return moves(grid.size, start, graphDijkstras.run(start, g.j * grid.size + g.i));
+        },
+        [&]() { return countsOf(graphDijkstras.stats()); }), true);
+
+    // Abstract paths are not optimal, the cost above the optimum is shown
+    AI::HierarchicalPathfinder hierarchical(&getAdjacents);
+    report(grid, "Hierarchical", measure(grid, list,
+        [&](AI::Key s, AI::Key g) { return hierarchical.run(s, g); },
+        [&]() { return countsOf(hierarchical.stats()); }), false);
+}
+
+// Usage: bench.out [max-size] [queries] [seed] [file.map ...]
+int main(int argc, char* argv[])
+{
+    int maxSize = argc > 1 ? std::atoi(argv[1]) : 1024;
+    int count = argc > 2 ? std::atoi(argv[2]) : 100;
+    unsigned seed = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 2022;
+
+    if (maxSize < 64 || maxSize > 4096 || count < 1)
+    {
+        std::cout << "Usage: bench.out [max-size 64..4096] [queries] [seed] [file.map ...]" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(14) << "map"
+              << std::right << std::setw(6) << "size" << "  "
+              << std::left << std::setw(22) << "engine"
+              << std::right << std::setw(11) << "mean ms"
+              << std::setw(11) << "p99 ms"
+              << std::setw(12) << "expanded"
+              << std::setw(12) << "heap ops"
+              << std::setw(12) << "peak KiB"
+              << "  cost" << std::endl;
+
+    std::mt19937 rng(seed);
+
+    for (int a = 4; a < argc; ++a)
+    {
+        Grid grid;
+        if (loadGrid(argv[a], grid))
+            bench(grid, count, rng);
+        else
+            std::cout << argv[a] << ": not a readable map" << std::endl;
+    }
+
+    for (int size = 64; size <= maxSize; size *= 4)
+    {
+        for (double density : { 0.1, 0.2, 0.3 })
+        {
+            Grid grid = randomGrid(size, density, rng);
+            bench(grid, count, rng);
+        }
+        Grid rooms = roomsGrid(size, rng);
+        bench(rooms, count, rng);
+        Grid maze = mazeGrid(size, rng);
+        bench(maze, count, rng);
+    }
+
+    return 0;
+}
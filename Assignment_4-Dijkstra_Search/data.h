@@ -5,47 +5,78 @@
 #include <deque>
 #include <list>
 #include <vector>
-#include <initializer_list>
+#include <array>
+#include <cstdint>
+#include <cassert>
+#include <type_traits>
+#include <algorithm>
+#include <new>
+
+// Search instrumentation. Defining NSTATS compiles the counting, timing
+// and tracing out of the searches, their stats then stay zero
+#ifdef NSTATS
+#define STATS(...)
+#else
+#define STATS(...) __VA_ARGS__
+#endif
 
 namespace AI
 {
-    // Key part from key-value pairs that are used in hash tables
-    class Key : public std::vector<int>
+    // Key part from key-value pairs that are used in hash tables. It is a
+    // map position [j, i] packed into 32 bits, trivially copyable, so keys
+    // are built, passed and stored without allocations. Each coordinate
+    // must fit in 16 bits, so maps are at most 32767 cells on a side, one
+    // less than the range so the cells just past the edge have keys too
+    class Key
     {
     public:
-        Key(const std::initializer_list<int>& list)
+        std::int16_t j;
+        std::int16_t i;
+
+        constexpr Key(int j = 0, int i = 0)
+            : j{ static_cast<std::int16_t>(j) }, i{ static_cast<std::int16_t>(i) }
         {
-            for (auto it = list.begin(); it != list.end(); ++it)
-                push_back(*it);
+            // A wrapped coordinate would alias another cell in the tables
+            assert(j == this->j && i == this->i);
         }
 
-        int pop() 
+        constexpr std::uint32_t packed() const
         {
-            int n = front();
-            erase(begin());
-            return n;
+            return static_cast<std::uint32_t>(static_cast<std::uint16_t>(j)) << 16
+                | static_cast<std::uint16_t>(i);
         }
 
-        bool operator==(const Key& rhs) const
+        // Fibonacci hashing, the high half of the product is well mixed
+        size_t hash() const
         {
-            if (size() != rhs.size())
-                return false;
+            return static_cast<size_t>((packed() * 0x9E3779B97F4A7C15ull) >> 32);
+        }
 
-            for (auto ia = begin(), ib = rhs.begin(); ia != end(); ++ia, ++ib)
-                if (*ia != *ib)
-                    return false;
+        constexpr bool operator==(const Key& rhs) const
+        {
+            return packed() == rhs.packed();
+        }
 
-            return true;
+        constexpr bool operator!=(const Key& rhs) const
+        {
+            return packed() != rhs.packed();
+        }
+
+        constexpr bool operator<(const Key& rhs) const
+        {
+            return j < rhs.j || (j == rhs.j && i < rhs.i);
         }
 
         friend std::ostream& operator<<(std::ostream& os, const Key& rhs)
         {
-            for (auto it = rhs.begin(); it != rhs.end(); ++it)
-                os << *it << (it + 1 != rhs.end() ? "," : "");
+            os << rhs.j << "," << rhs.i;
             return os;
         }
     };
 
+    static_assert(std::is_trivially_copyable<Key>::value && sizeof(Key) == 4,
+                  "Key must stay a packed 32-bit value");
+
     // Node is used to keep track of visited nodes or nodes to be visited 
     // during search
     class Node
@@ -55,15 +86,17 @@ namespace AI
         int g;
         char info;
         Node* parent;
+        int index; // slot in the priority queue, -1 when not queued
+        int h;     // estimated cost to the target, 0 for plain Dijkstra
 
         Node(Key key = {}, int g = 0, char info = ' ', Node* parent = nullptr)
-            : key(key), g{ g }, info{ info }, parent{ parent }
+            : key(key), g{ g }, info{ info }, parent{ parent }, index{ -1 }, h{ 0 }
         {
         }
 
         static bool less(const Node* a, const Node* b) 
         { 
-            return a->g < b->g; 
+            return a->g + a->h < b->g + b->h; 
         }
 
         friend std::ostream& operator<<(std::ostream& os, const Node& rhs)
@@ -76,6 +109,93 @@ namespace AI
     };
 
 
+    static_assert(std::is_trivially_destructible<Node>::value,
+                  "NodePool releases nodes without running destructors");
+
+    // Arena for the nodes of searches. Nodes are carved out of large chunks
+    // with a pointer bump, a node that turns out to be a duplicate can be
+    // handed back to a free list, and clear() releases all nodes at once
+    // while keeping the chunks for the next search
+    class NodePool
+    {
+        static const size_t CHUNK = 1024; // nodes per chunk
+
+        std::vector<Node*> chunks;
+        size_t chunk; // chunk that is being carved
+        size_t used;  // nodes carved from it so far
+        Node* free;   // released nodes, linked through Node::parent
+        size_t live;
+
+    public:
+        NodePool()
+            : chunks{}
+            , chunk{ 0 }
+            , used{ 0 }
+            , free{ nullptr }
+            , live{ 0 }
+        {
+        }
+
+        ~NodePool()
+        {
+            for (auto block : chunks)
+                ::operator delete(block);
+        }
+
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        Node* make(Key key = {}, int g = 0, char info = ' ', Node* parent = nullptr)
+        {
+            void* memory = free;
+            if (free)
+                free = free->parent;
+            else
+            {
+                if (used == CHUNK)
+                {
+                    ++chunk;
+                    used = 0;
+                }
+                if (chunk == chunks.size())
+                    chunks.push_back(static_cast<Node*>(::operator new(CHUNK * sizeof(Node))));
+                memory = chunks[chunk] + used++;
+            }
+            ++live;
+            return new (memory) Node(key, g, info, parent);
+        }
+
+        // Give back one node, the next make() reuses its memory
+        void release(Node* node)
+        {
+            node->parent = free;
+            free = node;
+            --live;
+        }
+
+        // Release every node at once, all pointers into the pool dangle
+        void clear()
+        {
+            chunk = 0;
+            used = 0;
+            free = nullptr;
+            live = 0;
+        }
+
+        // Number of nodes made and not released yet
+        size_t size() const
+        {
+            return live;
+        }
+
+        // Number of nodes that fit in the chunks allocated so far
+        size_t capacity() const
+        {
+            return chunks.size() * CHUNK;
+        }
+    };
+
+
     // Abstract base class for domain specific functors that return adjacent nodes
     class GetAdjacents
     {
@@ -87,102 +207,689 @@ namespace AI
         }
 
         virtual std::vector<Node*> operator()(Key key) = 0;
+
+        // Nodes with an edge into key, as used by backward searches. The 
+        // info of each is the move from key to it, the same as operator()
+        // would report, so the default assumes every edge goes both ways
+        virtual std::vector<Node*> reverse(Key key)
+        {
+            return operator()(key);
+        }
+
+        // Same as operator(), but the nodes are made in pool and appended
+        // to list, which searches reuse between expansions. The default
+        // copies the nodes of operator(), domains override it to skip the
+        // heap allocations
+        virtual void operator()(Key key, NodePool& pool, std::vector<Node*>& list)
+        {
+            copy(operator()(key), pool, list);
+        }
+
+        // Same as reverse(), with the nodes made in pool
+        virtual void reverse(Key key, NodePool& pool, std::vector<Node*>& list)
+        {
+            copy(reverse(key), pool, list);
+        }
+
+        // Dimensions of the grid the keys address, 0 when keys are not 
+        // grid cells. Searches use them to pick a dense table
+        virtual int width() const
+        {
+            return 0;
+        }
+
+        virtual int height() const
+        {
+            return 0;
+        }
+
+        // Largest g a single adjacent node can carry, 0 when unknown.
+        // Bucket queues size their ring from it
+        virtual int maxCost() const
+        {
+            return 0;
+        }
+
+    private:
+        static void copy(const std::vector<Node*>& nodes, NodePool& pool, std::vector<Node*>& list)
+        {
+            for (auto node : nodes)
+            {
+                list.push_back(pool.make(node->key, node->g, node->info));
+                delete node;
+            }
+        }
     };
 
 
-    // Hash table that uses fixed size key of integers to 
-    // locate value in memory in constant time 
+    // Hash table that maps keys of any range to nodes. It uses open
+    // addressing with linear probing in one flat array, so a lookup is
+    // usually a single cache access. The nodes belong to the caller,
+    // usually a NodePool
     class HashTable
     {
-        Node* value;
-        HashTable* children[10];
+        struct Slot
+        {
+            Key key;
+            Node* value;
+        };
+
+        std::vector<Slot> slots;
+        size_t count;
 
     public:
         HashTable()
-            : value{ nullptr }
-            , children{ }
+            : slots(16, Slot{ {}, nullptr })
+            , count{ 0 }
         {
-            for (int i = 0; i < 10; ++i)
-                children[i] = nullptr;
         }
 
-        ~HashTable()
+        HashTable(const HashTable&) = delete;
+        HashTable& operator=(const HashTable&) = delete;
+
+        // Every key can be stored
+        bool accepts(const Key&) const
         {
-            for (auto child : children)
-            {
-                if (child)
-                {
-                    delete child->value;
-                    delete child;
-                }
-            }
+            return true;
+        }
+
+        // Forget all nodes but keep the slots, so a reused table does not
+        // allocate again for searches of a similar size
+        void clear()
+        {
+            for (auto& slot : slots)
+                slot.value = nullptr;
+            count = 0;
         }
 
         void add(Key key, Node* v)
         {
-            HashTable* pNode = this;
-            while (key.size())
-            {
-                int a = key.pop();
-                if (pNode->children[a] == nullptr)
-                    pNode->children[a] = new HashTable();
-                pNode = pNode->children[a];
-            }
-            if (pNode->value)
-              delete pNode->value;
-            pNode->value = v;
+            if ((count + 1) * 2 > slots.size())
+                grow();
+
+            Slot& slot = slots[probe(key)];
+            if (!slot.value)
+                ++count;
+            slot.key = key;
+            slot.value = v;
         }
 
         Node* find(Key key)
         {
-            HashTable* pNode = this;
-            while (key.size())
-            {
-                int a = key.pop();
-                if (pNode->children[a] == nullptr)
-                    return nullptr;
-                pNode = pNode->children[a];
-            }
-            return pNode->value;
+            return slots[probe(key)].value;
+        }
+
+    private:
+        // Slot that holds the key, or the empty slot where it would go
+        size_t probe(const Key& key) const
+        {
+            size_t mask = slots.size() - 1;
+            size_t i = key.hash() & mask;
+            while (slots[i].value && slots[i].key != key)
+                i = (i + 1) & mask;
+            return i;
+        }
+
+        void grow()
+        {
+            std::vector<Slot> old(slots.size() * 2, Slot{ {}, nullptr });
+            old.swap(slots);
+            for (auto& slot : old)
+                if (slot.value)
+                    slots[probe(slot.key)] = slot;
+        }
+    };
+
+    // Dense table for grid maps with one slot per cell at j * width + i, so
+    // a lookup is a single array access. Keys outside the grid are never
+    // found. The nodes belong to the caller, usually a NodePool
+    class GridTable
+    {
+        std::vector<Node*> cells;
+        std::vector<size_t> touched;    // indices of filled cells, for clear
+        int width;
+        int height;
+
+    public:
+        GridTable(int width, int height)
+            : cells(static_cast<size_t>(width) * height, nullptr)
+            , touched{}
+            , width{ width }
+            , height{ height }
+        {
+        }
+
+        GridTable(const GridTable&) = delete;
+        GridTable& operator=(const GridTable&) = delete;
+
+        // Only keys of cells on the grid can be stored
+        bool accepts(const Key& key) const
+        {
+            return key.j >= 0 && key.j < height
+                && key.i >= 0 && key.i < width;
+        }
+
+        // Forget all nodes in O(cells filled), so a table can be reused
+        // for many searches on a large grid without sweeping every cell
+        void clear()
+        {
+            for (auto index : touched)
+                cells[index] = nullptr;
+            touched.clear();
+        }
+
+        void add(Key key, Node* v)
+        {
+            size_t index = static_cast<size_t>(key.j) * width + key.i;
+            Node*& cell = cells[index];
+            if (!cell)
+                touched.push_back(index);
+            cell = v;
+        }
+
+        Node* find(Key key)
+        {
+            if (!accepts(key))
+                return nullptr;
+            return cells[static_cast<size_t>(key.j) * width + key.i];
+        }
+
+        size_t size() const
+        {
+            return cells.size();
+        }
+
+        // Node of the cell at index j * width + i, nullptr if not found yet
+        Node* at(size_t index) const
+        {
+            return cells[index];
         }
     };
 
     // Custom made priority queue that is similar to std::priority_queue but 
-    // in addition provide access to elements of the queue
-    class PriorityQueue : public std::list<Node*>
+    // in addition provide access to elements of the queue. It is an indexed
+    // binary heap: every queued node keeps its slot in Node::index, so push,
+    // pop and decrease-key are O(log n) and membership is O(1). The nodes
+    // belong to the caller
+    class PriorityQueue
     {
+        std::vector<Node*> heap;
+
     public:
-        ~PriorityQueue()
+        bool empty() const
         {
-            for (auto e : *this)
-                delete e;
+            return heap.empty();
+        }
+
+        size_t size() const
+        {
+            return heap.size();
+        }
+
+        // Forget all queued nodes without deleting them
+        void clear()
+        {
+            for (auto e : heap)
+                e->index = -1;
+            heap.clear();
+        }
+
+        Node* top() const
+        {
+            return heap.front();
         }
 
         Node* pop()
         {
-            Node* node = front();
-            pop_front();
+            Node* node = heap.front();
+            node->index = -1;
+            if (heap.size() > 1)
+            {
+                place(heap.back(), 0);
+                heap.pop_back();
+                down(0);
+            }
+            else
+                heap.pop_back();
             return node;
         }
 
         void push(Node* node)
         {
-            push_back(node);
-            sort(Node::less);
+            heap.push_back(node);
+            node->index = static_cast<int>(heap.size()) - 1;
+            up(node->index);
+        }
+
+        // Restore the order after g of a queued node was lowered
+        void decrease(Node* node)
+        {
+            up(node->index);
+        }
+
+        bool contains(const Node* node) const
+        {
+            return node->index >= 0
+                && node->index < static_cast<int>(heap.size())
+                && heap[node->index] == node;
         }
 
         Node* find(Key key)
         {
-            for (auto it = begin(); it != end(); ++it)
-                if ((*it)->key == key)
-                    return *it;
+            for (auto e : heap)
+                if (e->key == key)
+                    return e;
             return nullptr;
         }
 
         friend std::ostream& operator<<(std::ostream& os, const PriorityQueue& rhs)
         {
-            for (auto it = rhs.begin(); it != rhs.end(); ++it)
-                os << **it << "  ";
+            std::vector<Node*> sorted(rhs.heap);
+            std::stable_sort(sorted.begin(), sorted.end(), Node::less);
+            for (auto e : sorted)
+                os << *e << "  ";
+            return os;
+        }
+
+    private:
+        void place(Node* node, int i)
+        {
+            heap[i] = node;
+            node->index = i;
+        }
+
+        void up(int i)
+        {
+            Node* node = heap[i];
+            while (i > 0)
+            {
+                int parent = (i - 1) / 2;
+                if (!Node::less(node, heap[parent]))
+                    break;
+                place(heap[parent], i);
+                i = parent;
+            }
+            place(node, i);
+        }
+
+        void down(int i)
+        {
+            Node* node = heap[i];
+            int count = static_cast<int>(heap.size());
+            while (true)
+            {
+                int child = 2 * i + 1;
+                if (child >= count)
+                    break;
+                if (child + 1 < count && Node::less(heap[child + 1], heap[child]))
+                    ++child;
+                if (!Node::less(heap[child], node))
+                    break;
+                place(heap[child], i);
+                i = child;
+            }
+            place(node, i);
+        }
+    };
+
+    // Monotone priority queue for small integer costs (Dial's algorithm).
+    // Bucket k of a ring holds the nodes whose g + h is k modulo the ring
+    // size, and pop sweeps the ring forward, so push, pop and decrease-key
+    // are O(1) amortized. Every pushed key must lie within the ring size of
+    // the last popped one, which holds when the ring is more than twice the
+    // largest edge cost and the heuristic is consistent. Node::index holds
+    // the key a node is queued with, a lowered node is queued again and its
+    // old entry is skipped when swept. The nodes belong to the caller
+    class BucketQueue
+    {
+        std::vector<std::vector<Node*>> ring;
+        int current;    // key of the bucket being swept, -1 before the first push
+        size_t entries; // entries in the ring, old ones included
+        size_t count;   // nodes queued
+
+    public:
+        explicit BucketQueue(int maxCost)
+            : ring(2 * static_cast<size_t>(maxCost) + 1)
+            , current{ -1 }
+            , entries{ 0 }
+            , count{ 0 }
+        {
+        }
+
+        bool empty() const
+        {
+            return count == 0;
+        }
+
+        size_t size() const
+        {
+            return count;
+        }
+
+        // Forget all queued nodes without deleting them. The next push
+        // may have any key, as for a new search
+        void clear()
+        {
+            for (auto& bucket : ring)
+            {
+                for (auto e : bucket)
+                    e->index = -1;
+                bucket.clear();
+            }
+            current = -1;
+            entries = 0;
+            count = 0;
+        }
+
+        Node* pop()
+        {
+            for (;; ++current)
+            {
+                std::vector<Node*>& bucket = ring[current % ring.size()];
+                while (!bucket.empty())
+                {
+                    Node* node = bucket.back();
+                    bucket.pop_back();
+                    --entries;
+                    if (node->index == current)
+                    {
+                        node->index = -1;
+                        --count;
+                        return node;
+                    }
+                }
+            }
+        }
+
+        void push(Node* node)
+        {
+            ++count;
+            insert(node);
+        }
+
+        // Queue the node again under its lowered g
+        void decrease(Node* node)
+        {
+            insert(node);
+        }
+
+        bool contains(const Node* node) const
+        {
+            return node->index >= 0;
+        }
+
+    private:
+        void insert(Node* node)
+        {
+            int key = node->g + node->h;
+            if (current < 0)
+                current = key;
+            // Keys below the sweep only come from inconsistent heuristics,
+            // they are expanded next instead of being lost in the ring
+            int index = std::max(key, current);
+            // An edge dearer than the maxCost the ring was made for, as
+            // when a map was edited behind the back of the domain, would
+            // wrap around onto keys still to be swept
+            if (static_cast<size_t>(index - current) >= ring.size())
+                grow(static_cast<size_t>(index - current) + 1);
+            node->index = index;
+            ring[index % ring.size()].push_back(node);
+            ++entries;
+        }
+
+        // Spread the queued nodes over a ring of at least the given size,
+        // the old entries of nodes queued again are dropped on the way
+        void grow(size_t least)
+        {
+            std::vector<std::vector<Node*>> old(std::max(least, 2 * ring.size()));
+            old.swap(ring);
+            entries = 0;
+            for (size_t b = 0; b < old.size(); ++b)
+            {
+                for (auto e : old[b])
+                {
+                    if (e->index >= current && static_cast<size_t>(e->index) % old.size() == b)
+                    {
+                        ring[e->index % ring.size()].push_back(e);
+                        ++entries;
+                    }
+                }
+            }
+        }
+    };
+
+    // Indexed binary min-heap of integer ids with 64-bit keys, for searches
+    // that keep their state in flat arrays instead of Nodes. The heap slot
+    // of every id is kept in a side array, so changing the key of a queued
+    // id and removing it are O(log n)
+    class IndexHeap
+    {
+        std::vector<int> heap;
+        std::vector<long long> keys;
+        std::vector<int> slots; // slot in heap per id, -1 when not queued
+
+    public:
+        explicit IndexHeap(size_t count = 0)
+            : heap{}
+            , keys(count, 0)
+            , slots(count, -1)
+        {
+        }
+
+        // Make room for ids 0 to count - 1 and empty the heap
+        void resize(size_t count)
+        {
+            heap.clear();
+            keys.assign(count, 0);
+            slots.assign(count, -1);
+        }
+
+        void clear()
+        {
+            for (int id : heap)
+                slots[id] = -1;
+            heap.clear();
+        }
+
+        bool empty() const
+        {
+            return heap.empty();
+        }
+
+        size_t size() const
+        {
+            return heap.size();
+        }
+
+        bool contains(int id) const
+        {
+            return slots[id] >= 0;
+        }
+
+        int top() const
+        {
+            return heap.front();
+        }
+
+        long long topKey() const
+        {
+            return keys[heap.front()];
+        }
+
+        int pop()
+        {
+            int id = heap.front();
+            remove(id);
+            return id;
+        }
+
+        // Queue an id, or move it if it is queued already
+        void push(int id, long long key)
+        {
+            keys[id] = key;
+            if (!contains(id))
+            {
+                heap.push_back(id);
+                slots[id] = static_cast<int>(heap.size()) - 1;
+            }
+            up(slots[id]);
+            down(slots[id]);
+        }
+
+        void remove(int id)
+        {
+            int i = slots[id];
+            slots[id] = -1;
+            int last = heap.back();
+            heap.pop_back();
+            if (last == id)
+                return;
+            place(last, i);
+            up(i);
+            down(slots[last]);
+        }
+
+    private:
+        void place(int id, int i)
+        {
+            heap[i] = id;
+            slots[id] = i;
+        }
+
+        void up(int i)
+        {
+            int id = heap[i];
+            while (i > 0)
+            {
+                int parent = (i - 1) / 2;
+                if (keys[heap[parent]] <= keys[id])
+                    break;
+                place(heap[parent], i);
+                i = parent;
+            }
+            place(id, i);
+        }
+
+        void down(int i)
+        {
+            int id = heap[i];
+            int count = static_cast<int>(heap.size());
+            while (true)
+            {
+                int child = 2 * i + 1;
+                if (child >= count)
+                    break;
+                if (child + 1 < count && keys[heap[child + 1]] < keys[heap[child]])
+                    ++child;
+                if (keys[id] <= keys[heap[child]])
+                    break;
+                place(heap[child], i);
+                i = child;
+            }
+            place(id, i);
+        }
+    };
+
+    // Directed weighted graph in compressed sparse row form: the edges
+    // leaving node u are targets[offsets[u]] to targets[offsets[u + 1] - 1],
+    // with their weights at the same positions. Three flat arrays instead
+    // of a list per node, so scanning the edges of a node is a linear walk
+    class Graph
+    {
+    public:
+        std::vector<int> offsets; // node count + 1 entries
+        std::vector<int> targets;
+        std::vector<int> weights;
+
+        Graph()
+            : offsets(1, 0)
+            , targets{}
+            , weights{}
+        {
+        }
+
+        // Build from {from, to, weight} triples, edges with an id outside
+        // 0 to count - 1 are dropped. Edges of one node keep their order
+        static Graph fromEdges(int count, const std::vector<std::array<int, 3>>& edges)
+        {
+            Graph graph;
+            graph.offsets.assign(static_cast<size_t>(std::max(count, 0)) + 1, 0);
+
+            auto inside = [count](int id) { return id >= 0 && id < count; };
+            for (const std::array<int, 3>& edge : edges)
+                if (inside(edge[0]) && inside(edge[1]))
+                    ++graph.offsets[edge[0] + 1];
+            for (int u = 0; u < count; ++u)
+                graph.offsets[u + 1] += graph.offsets[u];
+
+            graph.targets.resize(graph.offsets.back());
+            graph.weights.resize(graph.offsets.back());
+            std::vector<int> next(graph.offsets.begin(), graph.offsets.end() - 1);
+            for (const std::array<int, 3>& edge : edges)
+            {
+                if (!inside(edge[0]) || !inside(edge[1]))
+                    continue;
+                int e = next[edge[0]]++;
+                graph.targets[e] = edge[1];
+                graph.weights[e] = edge[2];
+            }
+            return graph;
+        }
+
+        int size() const
+        {
+            return static_cast<int>(offsets.size()) - 1;
+        }
+
+        int edges() const
+        {
+            return offsets.back();
+        }
+
+        int begin(int u) const
+        {
+            return offsets[u];
+        }
+
+        int end(int u) const
+        {
+            return offsets[u + 1];
+        }
+    };
+
+    // Counters of one search, filled unless NSTATS is defined
+    struct SearchStats
+    {
+        size_t expanded;   // nodes whose adjacents were generated
+        size_t pushes;     // nodes added to the open list
+        size_t pops;       // nodes taken from the open list
+        size_t decreases;  // queued nodes that got a cheaper g
+        size_t closedHits; // adjacents dropped because they were final
+        size_t peakOpen;   // largest size of the open list
+        double seconds;    // wall time of the search
+
+        SearchStats()
+            : expanded{ 0 }
+            , pushes{ 0 }
+            , pops{ 0 }
+            , decreases{ 0 }
+            , closedHits{ 0 }
+            , peakOpen{ 0 }
+            , seconds{ 0.0 }
+        {
+        }
+
+        void clear()
+        {
+            *this = SearchStats{};
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const SearchStats& rhs)
+        {
+            os << "expanded " << rhs.expanded << " pushes " << rhs.pushes
+               << " pops " << rhs.pops << " decreases " << rhs.decreases
+               << " closed " << rhs.closedHits << " peak " << rhs.peakOpen
+               << " time " << rhs.seconds << 's';
             return os;
         }
     };
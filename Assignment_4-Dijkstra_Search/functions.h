@@ -15,171 +15,2697 @@ Implement the Dijkstra's algorithms for path searching.
 
 #include "data.h"
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <queue>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 
 #define UNUSED(x) (void)x;
 
 namespace AI
 {
-	// Domain specific functor that returns adjacent nodes
+	// Domain specific functor that returns adjacent nodes. A map value of 0
+	// is an empty cell, 1 a wall and any k >= 2 terrain that costs k times
+	// as much to enter. A straight move costs 10 times the weight of the
+	// cell entered, a diagonal move 14 times. Diagonal moves are named
+	// after the numpad (7 9 1 3) and never cut the corner of a wall. The
+	// map size is limited to what a Key holds, 32767 cells on a side
 	class GetMapAdjacents : public GetAdjacents
 	{
 		int* map; // the map with integers where 0 means an empty cell
 		int size; // width and hight of the map in elements
+		bool diagonal; // whether the 4 diagonal moves are allowed
+		int heaviest; // no cell weighs more, kept up to date by update
+
+		// Moves in the order W, E, N, S, then 7, 9, 1, 3
+		static constexpr int dj[8] = { 0, 0, -1, 1, -1, -1, 1, 1 };
+		static constexpr int di[8] = { -1, 1, 0, 0, -1, 1, -1, 1 };
+		static constexpr char moves[8] = { 'W', 'E', 'N', 'S', '7', '9', '1', '3' };
+
+	public:
+
+		GetMapAdjacents( int* map = nullptr, int size = 0, bool diagonal = false )
+			: GetAdjacents(), map{ map }, size{ size }, diagonal{ diagonal }, heaviest{ 1 }
+		{
+			if ( map && size > 0 )
+				heaviest = std::max( *std::max_element( map, map + size * size ), 1 );
+		}
+
+		/**
+		 * @brief
+		 * Tell the map that a cell changed weight. A heavier cell raises
+		 maxCost, a lighter one leaves it as it is, still an upper bound
+		 * @param cell
+		 * the cell that changed on the map
+		*/
+		void update( Key cell )
+		{
+			if ( passable( cell.j, cell.i ) )
+				heaviest = std::max( heaviest, weight( cell.j, cell.i ) );
+		}
+
+		/**
+		 * @brief 
+		 * Find all the adjacent nodes based on the key given
+		 * @return
+		 * List of all adjacent nodes found, g is the cost of the move
+		*/
+		std::vector<AI::Node*> operator()( Key key )
+		{
+			std::vector<AI::Node*> list = {};
+			adjacents( key, false, [&list]( Key next, int cost, char move )
+			{
+				list.push_back( new AI::Node( next, cost, move ) );
+			} );
+			return list;
+		}
+
+		/**
+		 * @brief
+		 * Find all the adjacent nodes based on the key given, made in a
+		 pool instead of on the heap
+		 * @param key
+		 * cell whose adjacents are found
+		 * @param pool
+		 * arena the nodes are made in
+		 * @param list
+		 * the adjacent nodes are appended to it
+		*/
+		void operator()( Key key, NodePool& pool, std::vector<Node*>& list )
+		{
+			adjacents( key, false, [&pool, &list]( Key next, int cost, char move )
+			{
+				list.push_back( pool.make( next, cost, move ) );
+			} );
+		}
+
+		/**
+		 * @brief
+		 * Cells with a move into the given one. The move back is the
+		 same kind of move but enters the given cell, so g is the cost
+		 of entering it
+		 * @param key
+		 * cell whose predecessors are found
+		 * @return
+		 * List of nodes, info is the move from key to them
+		*/
+		std::vector<AI::Node*> reverse( Key key )
+		{
+			std::vector<AI::Node*> list = {};
+			adjacents( key, true, [&list]( Key next, int cost, char move )
+			{
+				list.push_back( new AI::Node( next, cost, move ) );
+			} );
+			return list;
+		}
+
+		/**
+		 * @brief
+		 * Cells with a move into the given one, made in a pool
+		 * @param key
+		 * cell whose predecessors are found
+		 * @param pool
+		 * arena the nodes are made in
+		 * @param list
+		 * the nodes are appended to it
+		*/
+		void reverse( Key key, NodePool& pool, std::vector<Node*>& list )
+		{
+			adjacents( key, true, [&pool, &list]( Key next, int cost, char move )
+			{
+				list.push_back( pool.make( next, cost, move ) );
+			} );
+		}
+
+		/**
+		 * @brief
+		 * Test whether a cell can be entered
+		 * @param j
+		 * row of the cell
+		 * @param i
+		 * column of the cell
+		 * @return
+		 * false for walls and cells outside the map
+		*/
+		bool passable( int j, int i ) const
+		{
+			return map && j >= 0 && j < size && i >= 0 && i < size
+				&& map[j * size + i] != 1;
+		}
+
+		/**
+		 * @brief
+		 * Terrain weight of a passable cell
+		 * @param j
+		 * row of the cell
+		 * @param i
+		 * column of the cell
+		 * @return
+		 * 1 for empty cells, the map value for heavier terrain
+		*/
+		int weight( int j, int i ) const
+		{
+			return std::max( map[j * size + i], 1 );
+		}
+
+		/**
+		 * @brief
+		 * Whether diagonal moves are allowed
+		 * @return
+		 * true for an 8-connected map
+		*/
+		bool diagonals() const
+		{
+			return diagonal;
+		}
+
+		/**
+		 * @brief
+		 * The most expensive single move on the map, without a sweep
+		 over it: the heaviest weight is found once and kept by update
+		 * @return
+		 * 10 or 14 times the heaviest weight, 0 when there is no map
+		*/
+		int maxCost() const
+		{
+			return map ? heaviest * ( diagonal ? 14 : 10 ) : 0;
+		}
+
+		/**
+		 * @brief
+		 * Number of columns of the map
+		 * @return
+		 * size, or 0 when there is no map
+		*/
+		int width() const
+		{
+			return map ? size : 0;
+		}
+
+		/**
+		 * @brief
+		 * Number of rows of the map
+		 * @return
+		 * size, or 0 when there is no map
+		*/
+		int height() const
+		{
+			return map ? size : 0;
+		}
+
+	private:
+
+		/**
+		 * @brief
+		 * Visit every legal move from a cell, or into it
+		 * @param key
+		 * the cell
+		 * @param backward
+		 * visit the moves that enter key instead of leaving it
+		 * @param visit
+		 * called with the other cell, the cost and the move from key
+		*/
+		template<typename Visit>
+		void adjacents( Key key, bool backward, Visit visit ) const
+		{
+			if ( !map || key.j < 0 || key.j >= size || key.i < 0 || key.i >= size )
+				return;
+			if ( backward && !passable( key.j, key.i ) )
+				return;
+
+			for ( int d = 0; d < ( diagonal ? 8 : 4 ); ++d )
+			{
+				int j = key.j + dj[d], i = key.i + di[d];
+				if ( !passable( j, i ) )
+					continue;
+				// A diagonal move needs both cells beside it to be open
+				if ( d >= 4 && ( !passable( key.j, i ) || !passable( j, key.i ) ) )
+					continue;
+				int cost = ( d < 4 ? 10 : 14 ) * ( backward ? weight( key.j, key.i ) : weight( j, i ) );
+				visit( Key{ j, i }, cost, moves[d] );
+			}
+		}
+	};
+
+	// The same domain with every edge turned around, so a search from a
+	// cell over it finds the cheapest paths into that cell. The info of a
+	// node is still the move from its parent to it as reverse reports it,
+	// the move toward the root of the search is opposite( info )
+	class ReverseAdjacents : public GetAdjacents
+	{
+		GetAdjacents* pGetAdjacents;
+
+	public:
+
+		ReverseAdjacents( GetAdjacents* pGetAdjacents )
+			: GetAdjacents(), pGetAdjacents{ pGetAdjacents }
+		{}
+
+		std::vector<AI::Node*> operator()( Key key )
+		{
+			return pGetAdjacents->reverse( key );
+		}
+
+		void operator()( Key key, NodePool& pool, std::vector<Node*>& list )
+		{
+			pGetAdjacents->reverse( key, pool, list );
+		}
+
+		std::vector<AI::Node*> reverse( Key key )
+		{
+			return pGetAdjacents->operator()( key );
+		}
+
+		void reverse( Key key, NodePool& pool, std::vector<Node*>& list )
+		{
+			pGetAdjacents->operator()( key, pool, list );
+		}
+
+		int width() const
+		{
+			return pGetAdjacents->width();
+		}
+
+		int maxCost() const
+		{
+			return pGetAdjacents->maxCost();
+		}
+
+		int height() const
+		{
+			return pGetAdjacents->height();
+		}
+	};
+
+	// Admissible heuristics for A*. Each estimates the cost between two
+	// cells without ever overestimating it, in the units of GetMapAdjacents:
+	// 10 per straight move and 14 per diagonal move over empty cells
+
+	// No estimate at all, which makes A* expand like Dijkstra's algorithm
+	struct Zero
+	{
+		int operator()( Key, Key ) const
+		{
+			return 0;
+		}
+	};
+
+	// Exact cost on an empty 4-connected grid
+	struct Manhattan
+	{
+		int operator()( Key a, Key b ) const
+		{
+			return 10 * ( std::abs( a.j - b.j ) + std::abs( a.i - b.i ) );
+		}
+	};
+
+	// Exact cost on an empty 8-connected grid
+	struct Octile
+	{
+		int operator()( Key a, Key b ) const
+		{
+			int dj = std::abs( a.j - b.j );
+			int di = std::abs( a.i - b.i );
+			return 10 * std::max( dj, di ) + 4 * std::min( dj, di );
+		}
+	};
+
+	// Straight line distance, scaled by 7 * sqrt(2) instead of 10 so that
+	// it never exceeds the 14 of a diagonal move
+	struct Euclidean
+	{
+		int operator()( Key a, Key b ) const
+		{
+			int dj = a.j - b.j;
+			int di = a.i - b.i;
+			return static_cast<int>( 7 * std::sqrt( 2.0 * ( dj * dj + di * di ) ) );
+		}
+	};
+
+	/**
+	 * @brief
+	 * Based on the pointer to the node ,
+	 retrieve all the nodes info and
+	 return a container of characters
+	 * @param pNode
+	 * Pointer to the nodes
+	 * @return
+	 * List of info to the nodes
+	*/
+	inline std::vector<char> getPath( const Node* pNode )
+	{
+		std::vector<char> a{};
+		// Trace back to return a vector of moves (.info)
+		if ( pNode )
+		{
+			while ( pNode->parent )
+			{
+				a.push_back( pNode->info );
+				pNode = pNode->parent;
+			}
+			std::reverse( a.begin(), a.end() );
+		}
+		return a;
+	}
+
+	/**
+	 * @brief
+	 * The move that undoes another one
+	 * @param move
+	 * one of N,S,E,W or a numpad diagonal 7,9,1,3
+	 * @return
+	 * the opposite move
+	*/
+	inline char opposite( char move )
+	{
+		switch ( move )
+		{
+		case 'N': return 'S';
+		case 'S': return 'N';
+		case 'E': return 'W';
+		case 'W': return 'E';
+		case '7': return '3';
+		case '3': return '7';
+		case '9': return '1';
+		case '1': return '9';
+		default:  return move;
+		}
+	}
+
+	/**
+	 * @brief
+	 * Best-first search shared by the engines. Nodes are expanded in
+	 order of g + h, where g sums the costs GetAdjacents puts on the
+	 adjacent nodes and h comes from the heuristic.
+	 * @param getAdjacents
+	 * Domain specific functor that returns adjacent nodes
+	 * @param ht
+	 * Table of every node found so far
+	 * @param pq
+	 * Open list, nodes waiting for a final g: a PriorityQueue, or a
+	 BucketQueue for small integer costs. It is cleared first and
+	 left empty, so callers can reuse one queue across searches
+	 * @param pool
+	 * Arena every node is made in, the caller clears it once the
+	 result is no longer needed
+	 * @param starting
+	 * From the first key
+	 * @param target
+	 * To the last final destination key
+	 * @param heuristic
+	 * Admissible estimate of the cost between two keys
+	 * @param stop
+	 * Stop as soon as the target is popped instead of expanding
+	 every reachable node
+	 * @param stats
+	 * Optional counters, added to
+	 * @param trace
+	 * Optional stream that gets a line "j,i g h" per expanded node
+	 * @return
+	 * The target node, or nullptr if unreachable
+	*/
+	template<typename Table, typename Queue, typename Heuristic>
+	Node* search( GetAdjacents& getAdjacents, Table& ht, Queue& pq, NodePool& pool,
+				  Key starting, Key target, Heuristic heuristic, bool stop,
+				  SearchStats* stats = nullptr, std::ostream* trace = nullptr )
+	{
+		UNUSED( stats )
+		UNUSED( trace )
+		STATS( SearchStats ignored{}; )
+		STATS( SearchStats& counters = stats ? *stats : ignored; )
+
+		if ( !ht.accepts( starting ) )
+			return nullptr;
+
+		std::vector<Node*> list;	// adjacents of the node being expanded
+		pq.clear();
+		AI::Node* root = pool.make( starting );
+		root->h = heuristic( starting, target );
+		ht.add( root->key, root );
+		pq.push( root );
+		STATS( ++counters.pushes; counters.peakOpen = std::max( counters.peakOpen, pq.size() ); )
+		while ( !pq.empty() )
+		{
+			AI::Node* node = pq.pop();
+			STATS( ++counters.pops; )
+			if ( stop && node->key == target )
+			{
+				pq.clear();
+				return node;
+			}
+
+			STATS( ++counters.expanded; )
+			STATS( if ( trace ) *trace << node->key << ' ' << node->g << ' ' << node->h << '\n'; )
+			list.clear();
+			getAdjacents( node->key, pool, list );
+			for ( auto& adjnode : list )
+			{
+				if ( AI::Node* oldnode = ht.find( adjnode->key ) )
+				{
+					// Popped nodes are final, queued ones are
+					// improved in place instead of queued twice
+					int g = node->g + adjnode->g;
+					STATS( if ( !pq.contains( oldnode ) ) ++counters.closedHits; )
+					if ( pq.contains( oldnode ) && oldnode->g > g )
+					{
+						oldnode->g = g;
+						oldnode->parent = node;
+						oldnode->info = adjnode->info;
+						pq.decrease( oldnode );
+						STATS( ++counters.decreases; )
+					}
+					pool.release( adjnode );
+				}
+				else
+				{
+					adjnode->g += node->g;
+					adjnode->h = heuristic( adjnode->key, target );
+					adjnode->parent = node;
+					ht.add( adjnode->key, adjnode );
+					pq.push( adjnode );
+					STATS( ++counters.pushes; counters.peakOpen = std::max( counters.peakOpen, pq.size() ); )
+				}
+			}
+		}
+
+		return ht.find( target );
+	}
+
+	/**
+	 * @brief
+	 * Best-first search with its own open list
+	 * @param getAdjacents
+	 * Domain specific functor that returns adjacent nodes
+	 * @param ht
+	 * Table of every node found so far
+	 * @param pool
+	 * Arena every node is made in
+	 * @param starting
+	 * From the first key
+	 * @param target
+	 * To the last final destination key
+	 * @param heuristic
+	 * Admissible estimate of the cost between two keys
+	 * @param stop
+	 * Stop as soon as the target is popped
+	 * @return
+	 * The target node, or nullptr if unreachable
+	*/
+	template<typename Table, typename Heuristic>
+	Node* search( GetAdjacents& getAdjacents, Table& ht, NodePool& pool, Key starting,
+				  Key target, Heuristic heuristic, bool stop )
+	{
+		PriorityQueue pq{};
+		return search( getAdjacents, ht, pq, pool, starting, target, heuristic, stop );
+	}
+
+	/**
+	 * @brief
+	 * Run a search with the table that suits the keys: grid maps
+	 get a dense table, anything else a hashed one. The nodes of
+	 the search are released from the pool before returning
+	 * @param getAdjacents
+	 * Domain specific functor that returns adjacent nodes
+	 * @param pq
+	 * Open list, left empty
+	 * @param pool
+	 * Arena for the nodes, kept by the engine so its chunks are reused
+	 * @param starting
+	 * From the first key
+	 * @param target
+	 * To the last final destination key
+	 * @param heuristic
+	 * Admissible estimate of the cost between two keys
+	 * @param stop
+	 * Stop as soon as the target is popped
+	 * @param stats
+	 * Optional counters, reset and then filled with this search
+	 * @param trace
+	 * Optional stream that gets a line per expanded node
+	 * @return
+	 * List of key info (N,S,E,W)
+	*/
+	template<typename Queue, typename Heuristic>
+	std::vector<char> findPath( GetAdjacents& getAdjacents, Queue& pq, NodePool& pool,
+								Key starting, Key target, Heuristic heuristic, bool stop,
+								SearchStats* stats = nullptr, std::ostream* trace = nullptr )
+	{
+		STATS( if ( stats ) stats->clear(); )
+		STATS( auto begin = std::chrono::steady_clock::now(); )
+
+		std::vector<char> path;
+		if ( int width = getAdjacents.width() )
+		{
+			GridTable ht{ width, getAdjacents.height() };
+			path = getPath( search( getAdjacents, ht, pq, pool, starting, target, heuristic, stop,
+									stats, trace ) );
+		}
+		else
+		{
+			HashTable ht{};
+			path = getPath( search( getAdjacents, ht, pq, pool, starting, target, heuristic, stop,
+									stats, trace ) );
+		}
+		pool.clear();
+
+		STATS( if ( stats ) stats->seconds = std::chrono::duration<double>(
+				   std::chrono::steady_clock::now() - begin ).count(); )
+		return path;
+	}
+
+	/**
+	 * @brief
+	 * Run a search on a binary heap open list
+	 * @param getAdjacents
+	 * Domain specific functor that returns adjacent nodes
+	 * @param pool
+	 * Arena for the nodes, kept by the engine so its chunks are reused
+	 * @param starting
+	 * From the first key
+	 * @param target
+	 * To the last final destination key
+	 * @param heuristic
+	 * Admissible estimate of the cost between two keys
+	 * @param stop
+	 * Stop as soon as the target is popped
+	 * @param stats
+	 * Optional counters, reset and then filled with this search
+	 * @param trace
+	 * Optional stream that gets a line per expanded node
+	 * @return
+	 * List of key info (N,S,E,W)
+	*/
+	template<typename Heuristic>
+	std::vector<char> findPath( GetAdjacents& getAdjacents, NodePool& pool, Key starting,
+								Key target, Heuristic heuristic, bool stop,
+								SearchStats* stats = nullptr, std::ostream* trace = nullptr )
+	{
+		PriorityQueue pq{};
+		return findPath( getAdjacents, pq, pool, starting, target, heuristic, stop, stats, trace );
+	}
+
+	// Distances and shortest path parents of every cell reached by one
+	// single-source search. Paths from the source to any cell, and the next
+	// step from any cell back toward the source, are then answered from the
+	// flat arrays without searching again. The way back comes from a second
+	// search over the reversed edges: with weights and diagonal moves a move
+	// and its opposite can cost differently, so the paths from the source
+	// turned around are not always the cheapest ways back
+	class DistanceField
+	{
+		int width;
+		int height;
+		Key source;
+		std::vector<int> distance; // -1 for cells that were not reached
+		std::vector<int> parent;   // cell index of the parent, -1 if none
+		std::vector<char> info;    // move that entered the cell
+		std::vector<int> back;     // cost back to the source, -1 if there is no way
+		std::vector<char> step;    // first move of the cheapest way back
+
+	public:
+
+		DistanceField( int width = 0, int height = 0, Key source = {} )
+			: width{ width }, height{ height }, source{ source }
+			, distance( static_cast<size_t>( width ) * height, -1 )
+			, parent( static_cast<size_t>( width ) * height, -1 )
+			, info( static_cast<size_t>( width ) * height, ' ' )
+			, back( static_cast<size_t>( width ) * height, -1 )
+			, step( static_cast<size_t>( width ) * height, ' ' )
+		{}
+
+		/**
+		 * @brief
+		 * Copy the result of a finished search out of its table
+		 * @param ht
+		 * Table of a search that expanded every reachable cell
+		*/
+		void assign( const GridTable& ht )
+		{
+			for ( size_t k = 0; k < ht.size(); ++k )
+			{
+				if ( const Node* pNode = ht.at( k ) )
+				{
+					distance[k] = pNode->g;
+					info[k] = pNode->info;
+					if ( pNode->parent )
+						parent[k] = index( pNode->parent->key );
+				}
+			}
+		}
+
+		/**
+		 * @brief
+		 * Copy the result of a finished search over ReverseAdjacents from
+		 the source, the ways back from every cell
+		 * @param ht
+		 * Table of a backward search that expanded every cell with a way
+		 to the source
+		*/
+		void assignBack( const GridTable& ht )
+		{
+			for ( size_t k = 0; k < ht.size(); ++k )
+			{
+				if ( const Node* pNode = ht.at( k ) )
+				{
+					back[k] = pNode->g;
+					if ( pNode->parent )
+						step[k] = opposite( pNode->info );
+				}
+			}
+		}
+
+		Key getSource() const
+		{
+			return source;
+		}
+
+		/**
+		 * @brief
+		 * Cost of the shortest path from the source
+		 * @param target
+		 * Cell to look up
+		 * @return
+		 * The cost, or -1 when the cell cannot be reached
+		*/
+		int getDistance( Key target ) const
+		{
+			return inside( target ) ? distance[index( target )] : -1;
+		}
+
+		/**
+		 * @brief
+		 * Shortest path from the source to a cell
+		 * @param target
+		 * To the last final destination key
+		 * @return
+		 * List of key info (N,S,E,W), empty when unreachable
+		*/
+		std::vector<char> getPath( Key target ) const
+		{
+			std::vector<char> a{};
+			if ( getDistance( target ) < 0 )
+				return a;
+
+			for ( int k = index( target ); parent[k] >= 0; k = parent[k] )
+				a.push_back( info[k] );
+			std::reverse( a.begin(), a.end() );
+			return a;
+		}
+
+		/**
+		 * @brief
+		 * Cost of the cheapest way from a cell back to the source
+		 * @param from
+		 * Cell to look up
+		 * @return
+		 * The cost, or -1 when there is no way back
+		*/
+		int getDistanceBack( Key from ) const
+		{
+			return inside( from ) ? back[index( from )] : -1;
+		}
+
+		/**
+		 * @brief
+		 * Gradient descent toward the source: the first move of the
+		 cheapest way back, so following nextStep from any cell costs
+		 getDistanceBack of that cell
+		 * @param from
+		 * Cell an agent is standing on
+		 * @return
+		 * One of N,S,E,W or 7,9,1,3, or ' ' at the source or a cell
+		 without a way back
+		*/
+		char nextStep( Key from ) const
+		{
+			if ( getDistanceBack( from ) <= 0 )
+				return ' ';
+			return step[index( from )];
+		}
+
+	private:
+
+		bool inside( Key key ) const
+		{
+			return key.j >= 0 && key.j < height && key.i >= 0 && key.i < width;
+		}
+
+		int index( Key key ) const
+		{
+			return key.j * width + key.i;
+		}
+	};
+
+	// Counters and trace of the last search of an engine
+	class Instrumented
+	{
+	protected:
+		SearchStats statistics;
+		std::ostream* pTrace;
+
+	public:
+
+		Instrumented()
+			: statistics{}, pTrace{ nullptr }
+		{}
+
+		/**
+		 * @brief
+		 * Counters of the last search, all zero when NSTATS is defined
+		 * @return
+		 * the stats
+		*/
+		const SearchStats& stats() const
+		{
+			return statistics;
+		}
+
+		/**
+		 * @brief
+		 * Write a line "j,i g h" for every node the following searches
+		 expand, in order, to visualise how the search front grows
+		 * @param os
+		 * stream for the trace, nullptr to stop tracing
+		*/
+		void trace( std::ostream* os )
+		{
+			pTrace = os;
+		}
+	};
+
+	class Dijkstras : public Instrumented
+	{
+		GetAdjacents* pGetAdjacents;
+		NodePool pool;
+
+	public:
+
+		Dijkstras( GetAdjacents* pGetAdjacents )
+			: Instrumented(), pGetAdjacents( pGetAdjacents ), pool{}
+		{}
+
+		// starting and target are arrays of 2 elements [j, i] that define positions on the map
+
+		/**
+		 * @brief
+		 * Distance Hash Table:
+		 Well need a table that maps each nodes total distance
+		 from the starting node. The key will be the node and
+		 the value will be its running total.
+
+		 * Priority Queue:
+		 When we compare all the possible routes we could take,
+		 the priority queue will surface the smallest possible
+		 route. In this way, we dont have to scan an array
+		 every time asking, which is the smallest.
+
+		* Routes Hash Table:
+		 We need a way to keep track of the current path
+		 were building. The key will be the current node
+		 we are at and its value will be the node it came from.
+
+		 * @param starting
+		 * From the first key 
+		 * @param target
+		 * To the last final destination key
+		 * @return
+		 * List of key info (N,S,E,W)
+		 * 
+		*/
+		std::vector<char> run( Key starting, Key target )
+		{
+			return findPath( *pGetAdjacents, pool, starting, target, Zero{}, false,
+							 &statistics, pTrace );
+		}
+
+		/**
+		 * @brief
+		 * Settle every cell reachable from a source, then every cell
+		 with a way back to it, and keep the result. The stats add up
+		 both searches
+		 * @param starting
+		 * Source of all paths in the field
+		 * @return
+		 * The distance field, empty for keys that are not grid cells
+		*/
+		DistanceField field( Key starting )
+		{
+			int width = pGetAdjacents->width();
+			int height = pGetAdjacents->height();
+			DistanceField result{ width, height, starting };
+			if ( width )
+			{
+				STATS( statistics.clear(); )
+				PriorityQueue pq{};
+				{
+					GridTable ht{ width, height };
+					search( *pGetAdjacents, ht, pq, pool, starting, starting, Zero{}, false,
+							&statistics, pTrace );
+					result.assign( ht );
+					pool.clear();
+				}
+				{
+					ReverseAdjacents reversed{ pGetAdjacents };
+					GridTable ht{ width, height };
+					search( reversed, ht, pq, pool, starting, starting, Zero{}, false,
+							&statistics, pTrace );
+					result.assignBack( ht );
+					pool.clear();
+				}
+			}
+			return result;
+		}
+	};
+
+	// A* search on the same adjacency interface as Dijkstras. The heuristic
+	// is picked at compile time and the search stops once the target is
+	// popped, so point to point queries expand far fewer nodes
+	template<typename Heuristic = Manhattan>
+	class AStar : public Instrumented
+	{
+		GetAdjacents* pGetAdjacents;
+		Heuristic heuristic;
+		NodePool pool;
+
+	public:
+
+		AStar( GetAdjacents* pGetAdjacents, Heuristic heuristic = {} )
+			: Instrumented(), pGetAdjacents( pGetAdjacents ), heuristic( heuristic ), pool{}
+		{}
+
+		/**
+		 * @brief
+		 * Find the shortest path between two keys
+		 * @param starting
+		 * From the first key
+		 * @param target
+		 * To the last final destination key
+		 * @return
+		 * List of key info (N,S,E,W)
+		*/
+		std::vector<char> run( Key starting, Key target )
+		{
+			return findPath( *pGetAdjacents, pool, starting, target, heuristic, true,
+							 &statistics, pTrace );
+		}
+	};
+
+	// Dial's algorithm: the same search with a BucketQueue as the open list,
+	// so with small integer costs every queue operation is O(1) amortized
+	// instead of O(log n). The ring is sized from GetAdjacents::maxCost(),
+	// domains that do not know it fall back to the binary heap. The ring is
+	// kept between queries and only made again when maxCost changes. A
+	// heuristic other than Zero must be consistent
+	template<typename Heuristic = Zero>
+	class Dial : public Instrumented
+	{
+		GetAdjacents* pGetAdjacents;
+		Heuristic heuristic;
+		NodePool pool;
+		BucketQueue pq;
+		int ringCost; // maxCost the ring of pq was made for
+
+	public:
+
+		Dial( GetAdjacents* pGetAdjacents, Heuristic heuristic = {} )
+			: Instrumented(), pGetAdjacents( pGetAdjacents ), heuristic( heuristic ), pool{}
+			, pq{ 0 }, ringCost{ 0 }
+		{}
+
+		/**
+		 * @brief
+		 * Find the cheapest path between two keys
+		 * @param starting
+		 * From the first key
+		 * @param target
+		 * To the last final destination key
+		 * @return
+		 * List of key info (N,S,E,W and 7,9,1,3)
+		*/
+		std::vector<char> run( Key starting, Key target )
+		{
+			int maxCost = pGetAdjacents->maxCost();
+			if ( maxCost <= 0 )
+				return findPath( *pGetAdjacents, pool, starting, target, heuristic, true,
+								 &statistics, pTrace );
+
+			if ( maxCost != ringCost )
+			{
+				pq = BucketQueue{ maxCost };
+				ringCost = maxCost;
+			}
+			return findPath( *pGetAdjacents, pq, pool, starting, target, heuristic, true,
+							 &statistics, pTrace );
+		}
+	};
+
+	// Batch service for many point to point queries at once. A pool of
+	// worker threads stays alive between batches and takes queries from a
+	// shared counter, each worker reusing its own table and open list, so
+	// a query costs no more than the cells it touches. GetAdjacents is
+	// called from every worker at the same time and must not modify itself
+	template<typename Heuristic = Zero>
+	class PathService
+	{
+		// Buffers one worker keeps for all of its queries
+		struct Scratch
+		{
+			GridTable grid;
+			HashTable hash;
+			PriorityQueue pq;
+			NodePool pool;
+
+			Scratch( int width, int height )
+				: grid{ width, height }, hash{}, pq{}, pool{}
+			{}
+		};
+
+		GetAdjacents* pGetAdjacents;
+		Heuristic heuristic;
+		std::vector<std::unique_ptr<Scratch>> scratch;
+		std::vector<std::thread> workers;
+
+		// Current batch, guarded by mutex except for the atomic counter
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable done;
+		const std::vector<std::pair<Key, Key>>* pQueries;
+		std::vector<std::vector<char>>* pResults;
+		std::atomic<size_t> next;
+		unsigned batch;	// number of batches started, wakes the workers
+		size_t busy;	// workers still on the current batch
+		bool quit;
+
+	public:
+
+		/**
+		 * @brief
+		 * Start the worker pool
+		 * @param pGetAdjacents
+		 * Domain specific functor that returns adjacent nodes
+		 * @param threads
+		 * Number of workers, at least one
+		 * @param heuristic
+		 * Admissible estimate of the cost between two keys
+		*/
+		PathService( GetAdjacents* pGetAdjacents,
+					 unsigned threads = std::thread::hardware_concurrency(),
+					 Heuristic heuristic = {} )
+			: pGetAdjacents{ pGetAdjacents }, heuristic{ heuristic }, scratch{}, workers{}
+			, mutex{}, wake{}, done{}, pQueries{ nullptr }, pResults{ nullptr }
+			, next{ 0 }, batch{ 0 }, busy{ 0 }, quit{ false }
+		{
+			threads = std::max( threads, 1u );
+			for ( unsigned t = 0; t < threads; ++t )
+				scratch.push_back( std::make_unique<Scratch>( pGetAdjacents->width(),
+															  pGetAdjacents->height() ) );
+			for ( unsigned t = 0; t < threads; ++t )
+				workers.emplace_back( &PathService::work, this, std::ref( *scratch[t] ) );
+		}
+
+		~PathService()
+		{
+			{
+				std::lock_guard<std::mutex> lock{ mutex };
+				quit = true;
+			}
+			wake.notify_all();
+			for ( auto& worker : workers )
+				worker.join();
+		}
+
+		PathService( const PathService& ) = delete;
+		PathService& operator=( const PathService& ) = delete;
+
+		/**
+		 * @brief
+		 * Number of workers in the pool
+		 * @return
+		 * thread count
+		*/
+		size_t threads() const
+		{
+			return workers.size();
+		}
+
+		/**
+		 * @brief
+		 * Find the shortest path of every query, spread over the workers.
+		 Blocks until the whole batch is done
+		 * @param queries
+		 * Pairs of starting and target keys
+		 * @return
+		 * List of key info (N,S,E,W) per query, in the order of the
+		 queries, empty where the target is unreachable
+		*/
+		std::vector<std::vector<char>> run( const std::vector<std::pair<Key, Key>>& queries )
+		{
+			std::vector<std::vector<char>> results( queries.size() );
+			if ( queries.empty() )
+				return results;
+
+			std::unique_lock<std::mutex> lock{ mutex };
+			pQueries = &queries;
+			pResults = &results;
+			next = 0;
+			busy = workers.size();
+			++batch;
+			wake.notify_all();
+			done.wait( lock, [this] { return busy == 0; } );
+			pQueries = nullptr;
+			pResults = nullptr;
+			return results;
+		}
+
+	private:
+
+		/**
+		 * @brief
+		 * Worker loop: wait for a batch, answer queries until the
+		 counter runs past the end, report back
+		 * @param buffers
+		 * Scratch owned by this worker
+		*/
+		void work( Scratch& buffers )
+		{
+			unsigned seen = 0;
+			for ( ;; )
+			{
+				{
+					std::unique_lock<std::mutex> lock{ mutex };
+					wake.wait( lock, [this, seen] { return quit || batch != seen; } );
+					if ( quit )
+						return;
+					seen = batch;
+				}
+
+				// Each result slot is written by exactly one worker
+				const auto& queries = *pQueries;
+				for ( size_t q = next++; q < queries.size(); q = next++ )
+					( *pResults )[q] = solve( buffers, queries[q].first, queries[q].second );
+
+				std::lock_guard<std::mutex> lock{ mutex };
+				if ( --busy == 0 )
+					done.notify_one();
+			}
+		}
+
+		/**
+		 * @brief
+		 * Answer one query with a worker's scratch and leave it clean
+		 * @param buffers
+		 * Scratch owned by the calling worker
+		 * @param starting
+		 * From the first key
+		 * @param target
+		 * To the last final destination key
+		 * @return
+		 * List of key info (N,S,E,W)
+		*/
+		std::vector<char> solve( Scratch& buffers, Key starting, Key target )
+		{
+			std::vector<char> path;
+			if ( pGetAdjacents->width() )
+			{
+				path = getPath( search( *pGetAdjacents, buffers.grid, buffers.pq, buffers.pool,
+										starting, target, heuristic, true ) );
+				buffers.grid.clear();
+			}
+			else
+			{
+				path = getPath( search( *pGetAdjacents, buffers.hash, buffers.pq, buffers.pool,
+										starting, target, heuristic, true ) );
+				buffers.hash.clear();
+			}
+			buffers.pool.clear();
+			return path;
+		}
+	};
+
+	// Bidirectional Dijkstra for point to point queries. One search grows
+	// from the start over GetAdjacents, the other from the target over
+	// GetAdjacents::reverse, always advancing the smaller frontier. It stops
+	// once the two queue tops together cost at least the best meeting found,
+	// which settles about half the cells a one-sided search would. The
+	// stats add up both sides
+	class BidirectionalDijkstras : public Instrumented
+	{
+		GetAdjacents* pGetAdjacents;
+		NodePool pool;
+		std::vector<Node*> list;	// adjacents of the node being expanded
+
+		// Cheapest cell reached by both searches so far
+		struct Meeting
+		{
+			int cost;
+			Node* forward;
+			Node* backward;
+		};
+
+	public:
+
+		BidirectionalDijkstras( GetAdjacents* pGetAdjacents )
+			: Instrumented(), pGetAdjacents( pGetAdjacents ), pool{}, list{}
+		{}
+
+		/**
+		 * @brief
+		 * Find the shortest path between two keys
+		 * @param starting
+		 * From the first key
+		 * @param target
+		 * To the last final destination key
+		 * @return
+		 * List of key info (N,S,E,W)
+		*/
+		std::vector<char> run( Key starting, Key target )
+		{
+			STATS( statistics.clear(); )
+			STATS( auto begin = std::chrono::steady_clock::now(); )
+
+			std::vector<char> path;
+			if ( int width = pGetAdjacents->width() )
+			{
+				int height = pGetAdjacents->height();
+				GridTable forward{ width, height }, backward{ width, height };
+				path = search( forward, backward, starting, target );
+			}
+			else
+			{
+				HashTable forward{}, backward{};
+				path = search( forward, backward, starting, target );
+			}
+			pool.clear();
+
+			STATS( statistics.seconds = std::chrono::duration<double>(
+					   std::chrono::steady_clock::now() - begin ).count(); )
+			return path;
+		}
+
+	private:
+
+		/**
+		 * @brief
+		 * Run both searches with the given tables
+		 * @param forward
+		 * Table of every node the forward search found
+		 * @param backward
+		 * Table of every node the backward search found
+		 * @param starting
+		 * From the first key
+		 * @param target
+		 * To the last final destination key
+		 * @return
+		 * List of key info (N,S,E,W)
+		*/
+		template<typename Table>
+		std::vector<char> search( Table& forward, Table& backward, Key starting, Key target )
+		{
+			if ( !forward.accepts( starting ) || !backward.accepts( target ) || starting == target )
+				return {};
+
+			PriorityQueue pqf{}, pqb{};
+			Meeting meeting{ std::numeric_limits<int>::max(), nullptr, nullptr };
+
+			AI::Node* root = pool.make( starting );
+			forward.add( starting, root );
+			pqf.push( root );
+			root = pool.make( target );
+			backward.add( target, root );
+			pqb.push( root );
+			STATS( statistics.pushes += 2; statistics.peakOpen = 2; )
+
+			while ( !pqf.empty() && !pqb.empty()
+					&& pqf.top()->g + pqb.top()->g < meeting.cost )
+			{
+				if ( pqf.size() <= pqb.size() )
+					expand( pqf, forward, backward, false, meeting );
+				else
+					expand( pqb, backward, forward, true, meeting );
+				STATS( statistics.peakOpen = std::max( statistics.peakOpen, pqf.size() + pqb.size() ); )
+			}
+			pqf.clear();
+			pqb.clear();
+
+			if ( !meeting.forward )
+				return {};
+
+			// Moves to the meeting cell, then back along the backward tree
+			std::vector<char> a = getPath( meeting.forward );
+			for ( Node* pNode = meeting.backward; pNode->parent; pNode = pNode->parent )
+				a.push_back( opposite( pNode->info ) );
+			return a;
+		}
+
+		/**
+		 * @brief
+		 * Settle the top node of one side and relax its edges
+		 * @param pq
+		 * Open list of this side
+		 * @param own
+		 * Table of this side
+		 * @param other
+		 * Table of the opposite side, checked for meetings
+		 * @param backward
+		 * Whether this side follows edges in reverse
+		 * @param meeting
+		 * Best meeting found so far
+		*/
+		template<typename Table>
+		void expand( PriorityQueue& pq, Table& own, Table& other, bool backward, Meeting& meeting )
+		{
+			AI::Node* node = pq.pop();
+			STATS( ++statistics.pops; ++statistics.expanded; )
+			STATS( if ( pTrace ) *pTrace << node->key << ' ' << node->g << " 0\n"; )
+			list.clear();
+			if ( backward )
+				pGetAdjacents->reverse( node->key, pool, list );
+			else
+				pGetAdjacents->operator()( node->key, pool, list );
+			for ( auto& adjnode : list )
+			{
+				AI::Node* reached = own.find( adjnode->key );
+				if ( reached )
+				{
+					int g = node->g + adjnode->g;
+					STATS( if ( !pq.contains( reached ) ) ++statistics.closedHits; )
+					bool better = pq.contains( reached ) && reached->g > g;
+					if ( better )
+					{
+						reached->g = g;
+						reached->parent = node;
+						reached->info = adjnode->info;
+						pq.decrease( reached );
+						STATS( ++statistics.decreases; )
+					}
+					pool.release( adjnode );
+					if ( !better )
+						continue;
+				}
+				else
+				{
+					adjnode->g += node->g;
+					adjnode->parent = node;
+					own.add( adjnode->key, adjnode );
+					pq.push( adjnode );
+					STATS( ++statistics.pushes; )
+					reached = adjnode;
+				}
+
+				if ( AI::Node* there = other.find( reached->key ) )
+				{
+					if ( reached->g + there->g < meeting.cost )
+					{
+						meeting.cost = reached->g + there->g;
+						meeting.forward = backward ? there : reached;
+						meeting.backward = backward ? reached : there;
+					}
+				}
+			}
+		}
+	};
+
+	// Jump Point Search for uniform cost 4-connected grids. Straight runs of
+	// cells without forced neighbours are skipped in one jump, so the open
+	// list only ever holds jump points. Moving vertically also scans both
+	// horizontal directions at every step, which keeps the paths optimal.
+	// Terrain weights and diagonal moves of the map are ignored. The stats
+	// count jump points, the cells scanned by the jumps are not expanded
+	class JumpPointSearch : public Instrumented
+	{
+	protected:
+		GetMapAdjacents* pMap;
+		NodePool pool;
+
+		// Directions in the order W, E, N, S
+		static constexpr int dj[4] = { 0, 0, -1, 1 };
+		static constexpr int di[4] = { -1, 1, 0, 0 };
+		static constexpr char moves[4] = { 'W', 'E', 'N', 'S' };
+
+	public:
+
+		JumpPointSearch( GetMapAdjacents* pMap )
+			: Instrumented(), pMap( pMap ), pool{}
+		{}
+
+		virtual ~JumpPointSearch()
+		{}
+
+		/**
+		 * @brief
+		 * Find the shortest path between two cells
+		 * @param starting
+		 * From the first key
+		 * @param target
+		 * To the last final destination key
+		 * @return
+		 * List of key info (N,S,E,W), one per cell moved
+		*/
+		std::vector<char> run( Key starting, Key target )
+		{
+			STATS( statistics.clear(); )
+			int width = pMap->width();
+			if ( !width )
+				return {};
+
+			GridTable ht{ width, pMap->height() };
+			PriorityQueue pq{};
+			Manhattan heuristic{};
+			pool.clear();	// nodes of the previous run
+
+			if ( !ht.accepts( starting ) )
+				return {};
+
+			STATS( auto begin = std::chrono::steady_clock::now(); )
+			std::vector<char> path{};
+			AI::Node* root = pool.make( starting );
+			root->h = heuristic( starting, target );
+			ht.add( root->key, root );
+			pq.push( root );
+			STATS( ++statistics.pushes; statistics.peakOpen = 1; )
+			while ( !pq.empty() )
+			{
+				AI::Node* node = pq.pop();
+				STATS( ++statistics.pops; )
+				if ( node->key == target )
+				{
+					pq.clear();
+					path = getMoves( node );
+					break;
+				}
+
+				STATS( ++statistics.expanded; )
+				STATS( if ( pTrace ) *pTrace << node->key << ' ' << node->g << ' ' << node->h << '\n'; )
+
+				for ( int d = 0; d < 4; ++d )
+				{
+					// Going back the way we came is never useful
+					if ( node->parent && moves[d ^ 1] == node->info )
+						continue;
+
+					Key next;
+					if ( !jump( node->key, d, target, next ) )
+						continue;
+
+					int g = node->g + 10 * ( std::abs( next.j - node->key.j )
+											 + std::abs( next.i - node->key.i ) );
+
+					if ( AI::Node* oldnode = ht.find( next ) )
+					{
+						STATS( if ( !pq.contains( oldnode ) ) ++statistics.closedHits; )
+						if ( pq.contains( oldnode ) && oldnode->g > g )
+						{
+							oldnode->g = g;
+							oldnode->parent = node;
+							oldnode->info = moves[d];
+							pq.decrease( oldnode );
+							STATS( ++statistics.decreases; )
+						}
+					}
+					else
+					{
+						AI::Node* jumpnode = pool.make( next, g, moves[d], node );
+						jumpnode->h = heuristic( next, target );
+						ht.add( next, jumpnode );
+						pq.push( jumpnode );
+						STATS( ++statistics.pushes; statistics.peakOpen = std::max( statistics.peakOpen, pq.size() ); )
+					}
+				}
+			}
+
+			STATS( statistics.seconds = std::chrono::duration<double>(
+					   std::chrono::steady_clock::now() - begin ).count(); )
+			return path;
+		}
+
+	protected:
+
+		/**
+		 * @brief
+		 * Walk from a cell in one direction until a jump point
+		 * @param key
+		 * cell to jump from
+		 * @param d
+		 * direction index
+		 * @param target
+		 * the target is always a jump point
+		 * @param found
+		 * the jump point when there is one
+		 * @return
+		 * false when a wall or the map edge comes first
+		*/
+		virtual bool jump( Key key, int d, Key target, Key& found )
+		{
+			int j = key.j + dj[d];
+			int i = key.i + di[d];
+			while ( pMap->passable( j, i ) )
+			{
+				if ( ( j == target.j && i == target.i ) || forced( j, i, d )
+					 || ( dj[d] && ( line( j, i, 0, target ) || line( j, i, 1, target ) ) ) )
+				{
+					found = Key{ j, i };
+					return true;
+				}
+				j += dj[d];
+				i += di[d];
+			}
+			return false;
+		}
+
+		/**
+		 * @brief
+		 * Test whether a cell entered in some direction has a neighbour
+		 that can only be reached optimally through it
+		 * @param j
+		 * row of the cell
+		 * @param i
+		 * column of the cell
+		 * @param d
+		 * direction the cell was entered in
+		 * @return
+		 * true if the cell is a jump point
+		*/
+		bool forced( int j, int i, int d ) const
+		{
+			// The side neighbours are perpendicular to the move
+			int sj = di[d], si = dj[d];
+			return ( pMap->passable( j + sj, i + si ) && !pMap->passable( j + sj - dj[d], i + si - di[d] ) )
+				|| ( pMap->passable( j - sj, i - si ) && !pMap->passable( j - sj - dj[d], i - si - di[d] ) );
+		}
+
+		/**
+		 * @brief
+		 * Horizontal jump used while moving vertically
+		 * @param j
+		 * row to scan
+		 * @param i
+		 * column the scan starts next to
+		 * @param d
+		 * 0 for west or 1 for east
+		 * @param target
+		 * the target is always a jump point
+		 * @return
+		 * true if the scan finds a jump point before a wall
+		*/
+		bool line( int j, int i, int d, Key target )
+		{
+			Key found;
+			return jump( Key{ j, i }, d, target, found );
+		}
+
+		/**
+		 * @brief
+		 * Expand the jumps from the start to a node into single moves
+		 * @param pNode
+		 * last jump point of the path
+		 * @return
+		 * List of key info (N,S,E,W), one per cell moved
+		*/
+		static std::vector<char> getMoves( const Node* pNode )
+		{
+			std::vector<char> a{};
+			for ( ; pNode->parent; pNode = pNode->parent )
+			{
+				int steps = std::abs( pNode->key.j - pNode->parent->key.j )
+					+ std::abs( pNode->key.i - pNode->parent->key.i );
+				a.insert( a.end(), steps, pNode->info );
+			}
+			std::reverse( a.begin(), a.end() );
+			return a;
+		}
+	};
+
+	// JPS+ precomputes, for every cell and direction, how far the next
+	// jump point or wall is, so a jump at query time is a table lookup.
+	// Call precompute() again after the map changes
+	class JumpPointSearchPlus : public JumpPointSearch
+	{
+		// Four entries per cell in W, E, N, S order. A positive value is
+		// the distance to the next jump point, otherwise minus the number
+		// of cells that can be moved before a wall
+		std::vector<int> distances;
+		int size;
+
+	public:
+
+		JumpPointSearchPlus( GetMapAdjacents* pMap )
+			: JumpPointSearch( pMap ), distances{}, size{ 0 }
+		{
+			precompute();
+		}
+
+		/**
+		 * @brief
+		 * Compute the jump distances with one sweep per direction
+		*/
+		void precompute()
+		{
+			size = pMap->width();
+			distances.assign( static_cast<size_t>( size ) * size * 4, 0 );
+
+			// Horizontal distances depend only on the row
+			for ( int j = 0; j < size; ++j )
+			{
+				for ( int i = 1; i < size; ++i )
+					distances[slot( j, i, 0 )] = step( j, i - 1, 0, distances[slot( j, i - 1, 0 )] );
+				for ( int i = size - 2; i >= 0; --i )
+					distances[slot( j, i, 1 )] = step( j, i + 1, 1, distances[slot( j, i + 1, 1 )] );
+			}
+
+			// Vertical ones also stop where a horizontal jump succeeds
+			for ( int i = 0; i < size; ++i )
+			{
+				for ( int j = 1; j < size; ++j )
+					distances[slot( j, i, 2 )] = step( j - 1, i, 2, distances[slot( j - 1, i, 2 )] );
+				for ( int j = size - 2; j >= 0; --j )
+					distances[slot( j, i, 3 )] = step( j + 1, i, 3, distances[slot( j + 1, i, 3 )] );
+			}
+		}
+
+	protected:
+
+		/**
+		 * @brief
+		 * Jump with the precomputed distances. The target is a jump
+		 point when it is on the ray, and a vertical ray also stops on
+		 the row of the target so the horizontal scan toward it happens.
+		 * @param key
+		 * cell to jump from
+		 * @param d
+		 * direction index
+		 * @param target
+		 * the target cell
+		 * @param found
+		 * the jump point when there is one
+		 * @return
+		 * false when a wall or the map edge comes first
+		*/
+		bool jump( Key key, int d, Key target, Key& found ) override
+		{
+			int distance = distances[slot( key.j, key.i, d )];
+			int reach = std::abs( distance );
+
+			// How far along the ray the target row or column is
+			int along = dj[d] ? ( target.j - key.j ) * dj[d] : ( target.i - key.i ) * di[d];
+			bool inLine = dj[d] ? target.i == key.i : target.j == key.j;
+
+			if ( along > 0 && along <= reach && ( inLine || dj[d] ) )
+			{
+				found = Key{ key.j + along * dj[d], key.i + along * di[d] };
+				return true;
+			}
+			if ( distance > 0 )
+			{
+				found = Key{ key.j + distance * dj[d], key.i + distance * di[d] };
+				return true;
+			}
+			return false;
+		}
+
+	private:
+
+		size_t slot( int j, int i, int d ) const
+		{
+			return ( static_cast<size_t>( j ) * size + i ) * 4 + d;
+		}
+
+		/**
+		 * @brief
+		 * Distance from the cell before next, given the distance from next
+		 * @param j
+		 * row of the next cell
+		 * @param i
+		 * column of the next cell
+		 * @param d
+		 * direction index
+		 * @param distance
+		 * precomputed distance of the next cell
+		 * @return
+		 * the distance from the cell before it
+		*/
+		int step( int j, int i, int d, int distance ) const
+		{
+			if ( !pMap->passable( j, i ) )
+				return 0;
+			if ( forced( j, i, d )
+				 || ( dj[d] && ( distances[slot( j, i, 0 )] > 0 || distances[slot( j, i, 1 )] > 0 ) ) )
+				return 1;
+			return distance > 0 ? distance + 1 : distance - 1;
+		}
+	};
+
+	// Adjacents restricted to one rectangular cluster of a bigger map, with
+	// keys relative to the cluster corner, so the searches above can run on
+	// a cluster as if it were the whole map
+	class GetClusterAdjacents : public GetAdjacents
+	{
+		GetAdjacents* pGetAdjacents;
+		Key origin;  // top left cell of the cluster on the map
+		int rows;
+		int columns;
+
+	public:
+
+		GetClusterAdjacents( GetAdjacents* pGetAdjacents, Key origin, int rows, int columns )
+			: GetAdjacents(), pGetAdjacents{ pGetAdjacents }, origin{ origin }
+			, rows{ rows }, columns{ columns }
+		{}
+
+		/**
+		 * @brief
+		 * Adjacent nodes of a cell that lie inside the cluster
+		 * @param key
+		 * cell relative to the cluster corner
+		 * @return
+		 * List of adjacent nodes with keys relative to the cluster corner
+		*/
+		std::vector<AI::Node*> operator()( Key key )
+		{
+			return inside( pGetAdjacents->operator()( Key{ key.j + origin.j, key.i + origin.i } ) );
+		}
+
+		/**
+		 * @brief
+		 * Adjacent nodes of a cell that lie inside the cluster, made in
+		 a pool. Nodes outside the cluster go back to the pool
+		 * @param key
+		 * cell relative to the cluster corner
+		 * @param pool
+		 * arena the nodes are made in
+		 * @param list
+		 * the adjacent nodes are appended to it, with keys relative to
+		 the cluster corner
+		*/
+		void operator()( Key key, NodePool& pool, std::vector<Node*>& list )
+		{
+			size_t first = list.size();
+			pGetAdjacents->operator()( Key{ key.j + origin.j, key.i + origin.i }, pool, list );
+			inside( pool, list, first );
+		}
+
+		/**
+		 * @brief
+		 * Cells inside the cluster with a move into the given one
+		 * @param key
+		 * cell relative to the cluster corner
+		 * @return
+		 * List of nodes with keys relative to the cluster corner
+		*/
+		std::vector<AI::Node*> reverse( Key key )
+		{
+			return inside( pGetAdjacents->reverse( Key{ key.j + origin.j, key.i + origin.i } ) );
+		}
+
+		/**
+		 * @brief
+		 * Cells inside the cluster with a move into the given one, made
+		 in a pool
+		 * @param key
+		 * cell relative to the cluster corner
+		 * @param pool
+		 * arena the nodes are made in
+		 * @param list
+		 * the nodes are appended to it, with keys relative to the
+		 cluster corner
+		*/
+		void reverse( Key key, NodePool& pool, std::vector<Node*>& list )
+		{
+			size_t first = list.size();
+			pGetAdjacents->reverse( Key{ key.j + origin.j, key.i + origin.i }, pool, list );
+			inside( pool, list, first );
+		}
+
+		int width() const
+		{
+			return columns;
+		}
+
+		int maxCost() const
+		{
+			return pGetAdjacents->maxCost();
+		}
+
+		int height() const
+		{
+			return rows;
+		}
+
+	private:
+
+		/**
+		 * @brief
+		 * Keep the nodes inside the cluster, with keys made relative to
+		 its corner, and delete the others
+		 * @param list
+		 * nodes with keys on the whole map
+		 * @return
+		 * the kept nodes
+		*/
+		std::vector<AI::Node*> inside( std::vector<AI::Node*> list ) const
+		{
+			size_t count = 0;
+			for ( auto adjnode : list )
+			{
+				if ( local( adjnode ) )
+					list[count++] = adjnode;
+				else
+					delete adjnode;
+			}
+			list.resize( count );
+			return list;
+		}
+
+		/**
+		 * @brief
+		 * Keep the nodes inside the cluster, with keys made relative to
+		 its corner, and give the others back to the pool
+		 * @param pool
+		 * arena the nodes were made in
+		 * @param list
+		 * nodes from first on have keys on the whole map
+		 * @param first
+		 * first node to look at
+		*/
+		void inside( NodePool& pool, std::vector<Node*>& list, size_t first ) const
+		{
+			size_t count = first;
+			for ( size_t n = first; n < list.size(); ++n )
+			{
+				if ( local( list[n] ) )
+					list[count++] = list[n];
+				else
+					pool.release( list[n] );
+			}
+			list.resize( count );
+		}
+
+		/**
+		 * @brief
+		 * Make the key of a node relative to the cluster corner
+		 * @param adjnode
+		 * node with a key on the whole map
+		 * @return
+		 * whether the cell is inside the cluster, the key is only
+		 changed when it is
+		*/
+		bool local( Node* adjnode ) const
+		{
+			Key key{ adjnode->key.j - origin.j, adjnode->key.i - origin.i };
+			if ( key.j < 0 || key.j >= rows || key.i < 0 || key.i >= columns )
+				return false;
+			adjnode->key = key;
+			return true;
+		}
+	};
+
+	// Hierarchical path-finding (HPA*). The map is split into square
+	// clusters. Entrances between neighbouring clusters become abstract
+	// nodes, and the cost between every two entrances of one cluster is
+	// precomputed with an in-cluster Dijkstra. A query searches the small
+	// abstract graph, then refines each abstract edge into single moves.
+	// Paths are near optimal, and the octile heuristic keeps the searches
+	// admissible on maps with diagonal moves. After editing the map call
+	// update() on the changed cell, which rebuilds only the clusters that
+	// cell touches. The stats of a query add up the searches linking the
+	// start and target to the graph, the abstract search and the refining
+	class HierarchicalPathfinder : public Instrumented
+	{
+		// Precomputed cost between two entrances of one cluster
+		struct Edge
+		{
+			Key from;
+			Key to;
+			int cost;
+		};
+
+		// Entrances shorter than this get one transition in the middle,
+		// longer ones one at each end
+		static const int LONG_ENTRANCE = 6;
+
+		GetMapAdjacents* pMap;
+		int clusterSize;
+		int size;    // width and height of the map
+		int columns; // clusters per row
+		int rows;    // clusters per column
+
+		// Per cluster: transitions to the east and south neighbours, the
+		// entrance cells inside it and the costs between those
+		std::vector<std::vector<std::pair<Key, Key>>> east;
+		std::vector<std::vector<std::pair<Key, Key>>> south;
+		std::vector<std::vector<Key>> entrances;
+		std::vector<std::vector<Edge>> edges;
+
+		// Abstract graph flattened for queries, rebuilt after edits
+		bool dirty;
+		std::vector<Key> keys;
+		std::vector<std::vector<std::pair<int, int>>> links;
+		std::unordered_map<std::uint32_t, int> ids;
 
 	public:
 
-		GetMapAdjacents( int* map = nullptr, int size = 0 )
-			: GetAdjacents(), map{ map }, size{ size }
-		{}
+		HierarchicalPathfinder( GetMapAdjacents* pMap, int clusterSize = 16 )
+			: Instrumented(), pMap{ pMap }, clusterSize{ clusterSize }, size{ 0 }, columns{ 0 }, rows{ 0 }
+			, east{}, south{}, entrances{}, edges{}, dirty{ true }, keys{}, links{}, ids{}
+		{
+			build();
+		}
+
+		/**
+		 * @brief
+		 * Precompute every cluster of the map from scratch
+		*/
+		void build()
+		{
+			size = pMap->width();
+			columns = rows = ( size + clusterSize - 1 ) / clusterSize;
+			int count = columns * rows;
+
+			east.assign( count, {} );
+			south.assign( count, {} );
+			entrances.assign( count, {} );
+			edges.assign( count, {} );
+
+			for ( int c = 0; c < count; ++c )
+			{
+				buildBorder( c, true );
+				buildBorder( c, false );
+			}
+			for ( int c = 0; c < count; ++c )
+				buildCluster( c );
+			dirty = true;
+		}
+
+		/**
+		 * @brief
+		 * Rebuild what depends on one cell after it was edited on the map:
+		 its cluster, plus the borders and neighbour clusters when the
+		 cell is on the edge of its cluster. The map is told as well
+		 * @param cell
+		 * the edited cell
+		*/
+		void update( Key cell )
+		{
+			if ( cell.j < 0 || cell.j >= size || cell.i < 0 || cell.i >= size )
+				return;
+			pMap->update( cell );
+
+			int c = clusterOf( cell );
+			int cj = c / columns, ci = c % columns;
+			Key first = corner( c );
+			std::vector<int> touched{ c };
+
+			if ( cell.i == std::min( size, first.i + clusterSize ) - 1 && ci + 1 < columns )
+			{
+				buildBorder( c, true );
+				touched.push_back( c + 1 );
+			}
+			if ( cell.i == first.i && ci > 0 )
+			{
+				buildBorder( c - 1, true );
+				touched.push_back( c - 1 );
+			}
+			if ( cell.j == std::min( size, first.j + clusterSize ) - 1 && cj + 1 < rows )
+			{
+				buildBorder( c, false );
+				touched.push_back( c + columns );
+			}
+			if ( cell.j == first.j && cj > 0 )
+			{
+				buildBorder( c - columns, false );
+				touched.push_back( c - columns );
+			}
+
+			for ( int t : touched )
+				buildCluster( t );
+			dirty = true;
+		}
+
+		/**
+		 * @brief
+		 * Number of nodes in the abstract graph
+		 * @return
+		 * count of entrance cells over all clusters
+		*/
+		size_t abstractSize()
+		{
+			compile();
+			return keys.size();
+		}
+
+		/**
+		 * @brief
+		 * Find a path through the abstract graph and refine it
+		 * @param starting
+		 * From the first key
+		 * @param target
+		 * To the last final destination key
+		 * @return
+		 * List of key info (N,S,E,W)
+		*/
+		std::vector<char> run( Key starting, Key target )
+		{
+			STATS( statistics.clear(); )
+			if ( !pMap->passable( starting.j, starting.i ) || !pMap->passable( target.j, target.i )
+				 || starting == target )
+				return {};
+
+			STATS( auto begin = std::chrono::steady_clock::now(); )
+			compile();
+
+			// The start and target join the graph as two extra nodes
+			int count = static_cast<int>( keys.size() );
+			int S = count, G = count + 1;
+			int cs = clusterOf( starting ), ct = clusterOf( target );
+
+			std::vector<std::pair<int, int>> fromStart = connect( cs, starting );
+			std::vector<std::pair<int, int>> toGoal = connect( ct, target, true, true );
+			if ( cs == ct )
+			{
+				int direct = costIn( cs, starting, target );
+				if ( direct >= 0 )
+					fromStart.push_back( { G, direct } );
+			}
+
+			// A* on the abstract graph
+			const int inf = std::numeric_limits<int>::max();
+			std::vector<int> g( count + 2, inf ), parent( count + 2, -1 );
+			std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>,
+								std::greater<std::pair<int, int>>> open;
+			Octile heuristic{};
+
+			auto relax = [&]( int u, int v, int cost )
+			{
+				if ( g[u] + cost < g[v] )
+				{
+					STATS( if ( g[v] < inf ) ++statistics.decreases; )
+					g[v] = g[u] + cost;
+					parent[v] = u;
+					open.push( { g[v] + ( v == G ? 0 : heuristic( v == S ? starting : keys[v], target ) ), v } );
+					STATS( ++statistics.pushes; statistics.peakOpen = std::max( statistics.peakOpen, open.size() ); )
+				}
+			};
+
+			g[S] = 0;
+			open.push( { heuristic( starting, target ), S } );
+			STATS( ++statistics.pushes; )
+			while ( !open.empty() )
+			{
+				int u = open.top().second;
+				int f = open.top().first;
+				open.pop();
+				STATS( ++statistics.pops; )
+				if ( u == G )
+					break;
+				if ( f - ( u == S ? heuristic( starting, target ) : heuristic( keys[u], target ) ) > g[u] )
+					continue; // stale entry
+				STATS( ++statistics.expanded; )
+
+				if ( u == S )
+				{
+					for ( auto& link : fromStart )
+						relax( u, link.first, link.second );
+					continue;
+				}
+				for ( auto& link : links[u] )
+					relax( u, link.first, link.second );
+				if ( clusterOf( keys[u] ) == ct )
+					for ( auto& link : toGoal )
+						if ( link.first == u )
+							relax( u, G, link.second );
+			}
+
+			if ( g[G] == inf )
+			{
+				STATS( statistics.seconds = std::chrono::duration<double>(
+						   std::chrono::steady_clock::now() - begin ).count(); )
+				return {};
+			}
+
+			// Refine every abstract edge into moves
+			std::vector<Key> waypoints{};
+			for ( int v = G; v != -1; v = parent[v] )
+				waypoints.push_back( v == S ? starting : v == G ? target : keys[v] );
+			std::reverse( waypoints.begin(), waypoints.end() );
+
+			std::vector<char> a{};
+			for ( size_t k = 1; k < waypoints.size(); ++k )
+			{
+				std::vector<char> segment = refine( waypoints[k - 1], waypoints[k] );
+				a.insert( a.end(), segment.begin(), segment.end() );
+			}
+
+			STATS( statistics.seconds = std::chrono::duration<double>(
+					   std::chrono::steady_clock::now() - begin ).count(); )
+			return a;
+		}
+
+	private:
+
+		int clusterOf( Key key ) const
+		{
+			return ( key.j / clusterSize ) * columns + key.i / clusterSize;
+		}
+
+		Key corner( int c ) const
+		{
+			return Key{ ( c / columns ) * clusterSize, ( c % columns ) * clusterSize };
+		}
+
+		GetClusterAdjacents adjacentsOf( int c )
+		{
+			Key first = corner( c );
+			return GetClusterAdjacents{ pMap, first,
+				std::min( clusterSize, size - first.j ), std::min( clusterSize, size - first.i ) };
+		}
 
 		/**
-		 * @brief 
-		 * Find all the adjacent nodes based on the key given
-		 * @return
-		 * List of all adjacent nodes found 
+		 * @brief
+		 * Find the transitions across the east or south border of a
+		 cluster, one or two for every run of open cell pairs
+		 * @param c
+		 * cluster index
+		 * @param toEast
+		 * true for the east border, false for the south one
 		*/
-		std::vector<AI::Node*> operator()( Key key )
+		void buildBorder( int c, bool toEast )
 		{
-			std::vector<AI::Node*> list = {};
+			std::vector<std::pair<Key, Key>>& transitions = toEast ? east[c] : south[c];
+			transitions.clear();
 
-			if ( map )
+			Key first = corner( c );
+			// Last row or column inside the cluster, the border is after it
+			int edge = std::min( size, ( toEast ? first.i : first.j ) + clusterSize ) - 1;
+			if ( edge + 1 >= size )
+				return;
+
+			int from = toEast ? first.j : first.i;
+			int to = std::min( size, from + clusterSize );
+			auto cell = [&]( int along, int across )
 			{
-				if ( key[1] - 1 >= 0 && map[key[0] * size + key[1] - 1] != 1 )
-				{
-					AI::Node* west = new AI::Node( { key[0], key[1] - 1 }, 10, 'W' );
-					list.push_back( west );
-				}
+				return toEast ? Key{ along, across } : Key{ across, along };
+			};
 
-				if ( key[1] + 1 < size && map[key[0] * size + key[1] + 1] != 1 )
+			int start = -1;
+			for ( int k = from; k <= to; ++k )
+			{
+				bool open = k < to
+					&& pMap->passable( cell( k, edge ).j, cell( k, edge ).i )
+					&& pMap->passable( cell( k, edge + 1 ).j, cell( k, edge + 1 ).i );
+				if ( open && start < 0 )
+					start = k;
+				else if ( !open && start >= 0 )
 				{
-					AI::Node* east = new AI::Node( { key[0], key[1] + 1 }, 10, 'E' );
-					list.push_back( east );
+					int length = k - start;
+					if ( length < LONG_ENTRANCE )
+					{
+						int middle = start + ( length - 1 ) / 2;
+						transitions.push_back( { cell( middle, edge ), cell( middle, edge + 1 ) } );
+					}
+					else
+					{
+						transitions.push_back( { cell( start, edge ), cell( start, edge + 1 ) } );
+						transitions.push_back( { cell( k - 1, edge ), cell( k - 1, edge + 1 ) } );
+					}
+					start = -1;
 				}
+			}
+		}
+
+		/**
+		 * @brief
+		 * Collect the entrance cells of a cluster and the in-cluster
+		 cost between every two of them
+		 * @param c
+		 * cluster index
+		*/
+		void buildCluster( int c )
+		{
+			std::vector<Key>& cells = entrances[c];
+			cells.clear();
+			for ( auto& t : east[c] )
+				cells.push_back( t.first );
+			for ( auto& t : south[c] )
+				cells.push_back( t.first );
+			if ( c % columns > 0 )
+				for ( auto& t : east[c - 1] )
+					cells.push_back( t.second );
+			if ( c >= columns )
+				for ( auto& t : south[c - columns] )
+					cells.push_back( t.second );
+			std::sort( cells.begin(), cells.end() );
+			cells.erase( std::unique( cells.begin(), cells.end() ), cells.end() );
+
+			edges[c].clear();
+			for ( Key from : cells )
+			{
+				for ( auto& link : connect( c, from, false ) )
+					edges[c].push_back( { from, cells[link.first], link.second } );
+			}
+		}
+
+		/**
+		 * @brief
+		 * In-cluster costs from a cell to the entrances of its cluster,
+		 or from the entrances to the cell
+		 * @param c
+		 * cluster index
+		 * @param cell
+		 * cell inside the cluster
+		 * @param global
+		 * report abstract node ids instead of entrance positions
+		 * @param backward
+		 * cost of the moves from each entrance to the cell, found by a
+		 search over the reversed moves, since with weights and diagonal
+		 moves the way there and the way back cost differently
+		 * @return
+		 * pairs of entrance and cost for the connected entrances
+		*/
+		std::vector<std::pair<int, int>> connect( int c, Key cell, bool global = true, bool backward = false )
+		{
+			GetClusterAdjacents adjacents = adjacentsOf( c );
+			ReverseAdjacents reversed{ &adjacents };
+			Key first = corner( c );
+			GridTable ht{ adjacents.width(), adjacents.height() };
+			PriorityQueue pq{};
+			NodePool pool{};
+			Key local{ cell.j - first.j, cell.i - first.i };
+			if ( backward )
+				search( reversed, ht, pq, pool, local, local, Zero{}, false, &statistics );
+			else
+				search( adjacents, ht, pq, pool, local, local, Zero{}, false, &statistics );
+
+			std::vector<std::pair<int, int>> result{};
+			const std::vector<Key>& cells = entrances[c];
+			for ( size_t k = 0; k < cells.size(); ++k )
+			{
+				if ( cells[k] == cell && !global )
+					continue;
+				if ( const Node* pNode = ht.find( Key{ cells[k].j - first.j, cells[k].i - first.i } ) )
+					result.push_back( { global ? ids[cells[k].packed()] : static_cast<int>( k ), pNode->g } );
+			}
+			return result;
+		}
+
+		/**
+		 * @brief
+		 * In-cluster cost between two cells of one cluster
+		 * @return
+		 * the cost, or -1 when the cluster does not connect them
+		*/
+		int costIn( int c, Key from, Key to )
+		{
+			GetClusterAdjacents adjacents = adjacentsOf( c );
+			Key first = corner( c );
+			GridTable ht{ adjacents.width(), adjacents.height() };
+			PriorityQueue pq{};
+			NodePool pool{};
+			Node* node = search( adjacents, ht, pq, pool, Key{ from.j - first.j, from.i - first.i },
+								 Key{ to.j - first.j, to.i - first.i }, Octile{}, true, &statistics );
+			return node ? node->g : -1;
+		}
+
+		/**
+		 * @brief
+		 * Moves between two consecutive waypoints of an abstract path:
+		 a single step across a border, or an in-cluster search
+		*/
+		std::vector<char> refine( Key from, Key to )
+		{
+			int c = clusterOf( from );
+			if ( c != clusterOf( to ) )
+			{
+				if ( to.j != from.j )
+					return { to.j > from.j ? 'S' : 'N' };
+				return { to.i > from.i ? 'E' : 'W' };
+			}
+
+			GetClusterAdjacents adjacents = adjacentsOf( c );
+			Key first = corner( c );
+			GridTable ht{ adjacents.width(), adjacents.height() };
+			PriorityQueue pq{};
+			NodePool pool{};
+			return getPath( search( adjacents, ht, pq, pool, Key{ from.j - first.j, from.i - first.i },
+									Key{ to.j - first.j, to.i - first.i }, Octile{}, true, &statistics ) );
+		}
 
-				if ( key[0] - 1 >= 0 && map[( key[0] - 1 ) * size + key[1]] != 1 )
+		/**
+		 * @brief
+		 * Flatten the per cluster data into the abstract graph
+		*/
+		void compile()
+		{
+			if ( !dirty )
+				return;
+
+			keys.clear();
+			ids.clear();
+			for ( auto& cells : entrances )
+			{
+				for ( Key cell : cells )
 				{
-					AI::Node* north = new AI::Node( { key[0] - 1 , key[1] }, 10, 'N' );
-					list.push_back( north );
+					ids[cell.packed()] = static_cast<int>( keys.size() );
+					keys.push_back( cell );
 				}
+			}
+
+			links.assign( keys.size(), {} );
+			for ( auto& list : edges )
+				for ( auto& edge : list )
+					links[ids[edge.from.packed()]].push_back( { ids[edge.to.packed()], edge.cost } );
 
-				if ( key[0] + 1 < size && map[( key[0] + 1 ) * size + key[1]] != 1 )
+			for ( auto* borders : { &east, &south } )
+			{
+				for ( auto& transitions : *borders )
 				{
-					AI::Node* south = new AI::Node( { key[0] + 1 , key[1] }, 10, 'S' );
-					list.push_back( south );
+					for ( auto& t : transitions )
+					{
+						// Crossing the border costs the weight of the cell entered
+						int a = ids[t.first.packed()], b = ids[t.second.packed()];
+						links[a].push_back( { b, 10 * pMap->weight( t.second.j, t.second.i ) } );
+						links[b].push_back( { a, 10 * pMap->weight( t.first.j, t.first.i ) } );
+					}
 				}
 			}
-			return list;
+			dirty = false;
 		}
 	};
 
-	class Dijkstras
+	// D* Lite, incremental replanning on a grid. The search runs backward
+	// from the target and keeps, for every cell, g and rhs (the cost the
+	// cell would get from its best successor) between calls. After the map
+	// changes, update() re-evaluates the cells whose moves changed, and the
+	// next run() expands only the cells that became inconsistent instead of
+	// searching again. The start may move between runs: km is added to all
+	// new keys so the queued ones stay valid without reordering the queue.
+	// The heuristic must be consistent
+	template<typename Heuristic = Octile>
+	class DStarLite
 	{
+		static constexpr int INF = std::numeric_limits<int>::max();
+
 		GetAdjacents* pGetAdjacents;
+		Heuristic heuristic;
+		NodePool pool;
+		std::vector<Node*> list;	// adjacents of the cell being looked at
+		std::vector<int> around;	// predecessors of the cell being expanded
+
+		int width;
+		int height;
+		std::vector<int> g;
+		std::vector<int> rhs;
+		IndexHeap open;		// inconsistent cells, keyed by key()
+		Key start;
+		Key goal;
+		int km;				// heuristic drift of the start since planning
+		bool planned;
+		size_t expanded;	// cells expanded by the last run
 
 	public:
 
-		Dijkstras( GetAdjacents* pGetAdjacents )
-			: pGetAdjacents( pGetAdjacents )
+		DStarLite( GetAdjacents* pGetAdjacents, Heuristic heuristic = {} )
+			: pGetAdjacents( pGetAdjacents ), heuristic( heuristic ), pool{}, list{}, around{}
+			, width{ 0 }, height{ 0 }, g{}, rhs{}, open{}, start{}, goal{}, km{ 0 }
+			, planned{ false }, expanded{ 0 }
 		{}
 
-		// starting and target are arrays of 2 elements [j, i] that define positions on the map
+		/**
+		 * @brief
+		 * Find the cheapest path, reusing the search of the previous run
+		 when the target is the same
+		 * @param starting
+		 * From the first key, may differ from the previous run
+		 * @param target
+		 * To the last final destination key, a new one plans from scratch
+		 * @return
+		 * List of key info (N,S,E,W and 7,9,1,3)
+		*/
+		std::vector<char> run( Key starting, Key target )
+		{
+			width = pGetAdjacents->width();
+			height = pGetAdjacents->height();
+			expanded = 0;
+			if ( !inside( starting ) || !inside( target ) )
+				return {};
+
+			if ( !planned || target != goal || g.size() != static_cast<size_t>( width ) * height )
+				initialize( starting, target );
+			else if ( starting != start )
+			{
+				km += heuristic( start, starting );
+				start = starting;
+			}
+
+			computeShortestPath();
+			return extract();
+		}
 
 		/**
 		 * @brief
-		 * Distance Hash Table:
-		 Well need a table that maps each nodes total distance
-		 from the starting node. The key will be the node and
-		 the value will be its running total.
+		 * Tell the planner that a cell was opened, blocked or changed
+		 weight. The cell and its 8 neighbours are re-evaluated, which
+		 covers every move into, out of or diagonally past the cell
+		 * @param cell
+		 * the cell that changed on the map
+		*/
+		void update( Key cell )
+		{
+			if ( !planned )
+				return;
+			for ( int dj = -1; dj <= 1; ++dj )
+				for ( int di = -1; di <= 1; ++di )
+					if ( inside( Key{ cell.j + dj, cell.i + di } ) )
+						updateVertex( index( Key{ cell.j + dj, cell.i + di } ) );
+		}
 
-		 * Priority Queue:
-		 When we compare all the possible routes we could take,
-		 the priority queue will surface the smallest possible
-		 route. In this way, we dont have to scan an array
-		 every time asking, which is the smallest.
+		/**
+		 * @brief
+		 * Number of cells the last run expanded
+		 * @return
+		 * the count, 0 when the run only read the kept search
+		*/
+		size_t expansions() const
+		{
+			return expanded;
+		}
 
-		* Routes Hash Table:
-		 We need a way to keep track of the current path
-		 were building. The key will be the current node
-		 we are at and its value will be the node it came from.
+	private:
 
-		 * @param starting
-		 * From the first key 
-		 * @param target
-		 * To the last final destination key
+		bool inside( Key key ) const
+		{
+			return key.j >= 0 && key.j < height && key.i >= 0 && key.i < width;
+		}
+
+		int index( Key key ) const
+		{
+			return key.j * width + key.i;
+		}
+
+		Key cell( int s ) const
+		{
+			return Key{ s / width, s % width };
+		}
+
+		/**
+		 * @brief
+		 * Queue key of a cell: the estimated cost of a path through it
+		 first, then its own cost to break ties
+		*/
+		long long key( int s ) const
+		{
+			int m = std::min( g[s], rhs[s] );
+			if ( m == INF )
+				return std::numeric_limits<long long>::max();
+			long long first = static_cast<long long>( m ) + heuristic( start, cell( s ) ) + km;
+			return first << 32 | m;
+		}
+
+		void initialize( Key starting, Key target )
+		{
+			size_t count = static_cast<size_t>( width ) * height;
+			g.assign( count, INF );
+			rhs.assign( count, INF );
+			open.resize( count );
+			start = starting;
+			goal = target;
+			km = 0;
+			planned = true;
+
+			rhs[index( goal )] = 0;
+			open.push( index( goal ), key( index( goal ) ) );
+		}
+
+		/**
+		 * @brief
+		 * Recompute rhs of a cell from its successors and queue it if
+		 it is inconsistent
+		 * @param u
+		 * index of the cell
+		*/
+		void updateVertex( int u )
+		{
+			if ( u != index( goal ) )
+			{
+				rhs[u] = INF;
+				list.clear();
+				pGetAdjacents->operator()( cell( u ), pool, list );
+				for ( auto adjnode : list )
+				{
+					if ( !inside( adjnode->key ) )
+						continue;
+					int next = g[index( adjnode->key )];
+					if ( next != INF )
+						rhs[u] = std::min( rhs[u], adjnode->g + next );
+				}
+				pool.clear();
+			}
+
+			if ( g[u] != rhs[u] )
+				open.push( u, key( u ) );
+			else if ( open.contains( u ) )
+				open.remove( u );
+		}
+
+		/**
+		 * @brief
+		 * Expand inconsistent cells until the start is consistent and
+		 no queued cell could still improve it
+		*/
+		void computeShortestPath()
+		{
+			int s = index( start );
+			while ( !open.empty() && ( open.topKey() < key( s ) || rhs[s] != g[s] ) )
+			{
+				int u = open.top();
+				long long old = open.topKey();
+				long long now = key( u );
+				++expanded;
+
+				if ( old < now )
+				{
+					// Queued before the start moved, the key only grew
+					open.push( u, now );
+					continue;
+				}
+
+				around.clear();
+				list.clear();
+				pGetAdjacents->reverse( cell( u ), pool, list );
+				for ( auto adjnode : list )
+					if ( inside( adjnode->key ) )
+						around.push_back( index( adjnode->key ) );
+				pool.clear();
+
+				if ( g[u] > rhs[u] )
+				{
+					// Overconsistent: the cost dropped, settle it
+					g[u] = rhs[u];
+					open.remove( u );
+				}
+				else
+				{
+					// Underconsistent: the cost rose, reopen it
+					g[u] = INF;
+					updateVertex( u );
+				}
+				for ( int p : around )
+					updateVertex( p );
+			}
+		}
+
+		/**
+		 * @brief
+		 * Walk from the start to the cheapest successor until the target
 		 * @return
-		 * List of key info (N,S,E,W)
-		 * 
+		 * List of key info, empty when the target cannot be reached
 		*/
-		std::vector<char> run( Key starting, Key target )
+		std::vector<char> extract()
 		{
-			HashTable ht{};		//close list
-			PriorityQueue pq{};	//open list
+			std::vector<char> path{};
+			if ( g[index( start )] == INF )
+				return path;
 
-			AI::Node* root = new AI::Node( starting );
-			ht.add( root->key, root );
-			for ( auto& data : pGetAdjacents->operator()( starting ) )
+			Key current = start;
+			for ( size_t steps = 0; current != goal && steps < g.size(); ++steps )
 			{
-				data->parent = root;
-				data->g = root->g + 1;
-				pq.push( data );
+				list.clear();
+				pGetAdjacents->operator()( current, pool, list );
+
+				Node* best = nullptr;
+				long long cost = INF;
+				for ( auto adjnode : list )
+				{
+					if ( !inside( adjnode->key ) || g[index( adjnode->key )] == INF )
+						continue;
+					if ( adjnode->g + static_cast<long long>( g[index( adjnode->key )] ) < cost )
+					{
+						cost = adjnode->g + static_cast<long long>( g[index( adjnode->key )] );
+						best = adjnode;
+					}
+				}
+				if ( best )
+				{
+					path.push_back( best->info );
+					current = best->key;
+				}
+				pool.clear();
+				if ( !best )
+					return {};
 			}
-			while ( !pq.empty() )
+			return current == goal ? path : std::vector<char>{};
+		}
+	};
+
+	// Dijkstra's algorithm on a Graph with integer node ids. Distances and
+	// parents live in flat arrays indexed by id and the open list is an
+	// IndexHeap, so a search allocates nothing once the arrays are sized.
+	// Only the entries a search touched are reset by the next one. Edge
+	// weights must not be negative
+	class GraphDijkstras : public Instrumented
+	{
+		const Graph* pGraph;
+		int source;
+		std::vector<int> distance;	// -1 for nodes that were not reached
+		std::vector<int> parent;	// -1 for the source and unreached nodes
+		std::vector<bool> closed;
+		std::vector<int> touched;	// ids reached by the last search
+		IndexHeap open;
+
+	public:
+
+		GraphDijkstras( const Graph* pGraph )
+			: Instrumented(), pGraph( pGraph ), source{ -1 }, distance{}, parent{}, closed{}
+			, touched{}, open{}
+		{}
+
+		/**
+		 * @brief
+		 * Find the shortest path between two nodes
+		 * @param starting
+		 * From the first node id
+		 * @param target
+		 * To the last node id, -1 to settle every reachable node
+		 * @return
+		 * List of node ids after the starting one, ending with the target
+		*/
+		std::vector<int> run( int starting, int target )
+		{
+			reset();
+			STATS( statistics.clear(); )
+			STATS( auto begin = std::chrono::steady_clock::now(); )
+			if ( starting < 0 || starting >= pGraph->size() )
+				return {};
+
+			source = starting;
+			reach( starting, 0, -1 );
+			while ( !open.empty() )
 			{
-				AI::Node* node = pq.pop();
-				for ( auto& adjnode : pGetAdjacents->operator()( node->key ) )
+				int u = open.pop();
+				STATS( ++statistics.pops; )
+				closed[u] = true;
+				if ( u == target )
+					break;
+
+				STATS( ++statistics.expanded; )
+				STATS( if ( pTrace ) *pTrace << u << ' ' << distance[u] << " 0\n"; )
+				for ( int e = pGraph->begin( u ); e < pGraph->end( u ); ++e )
 				{
-					if ( AI::Node* oldnode = ht.find( adjnode->key ) )
+					int v = pGraph->targets[e];
+					int d = distance[u] + pGraph->weights[e];
+					if ( closed[v] )
 					{
-						if ( oldnode->g > node->g + 1 )
-						{
-							oldnode->g = node->g + 1;
-							oldnode->parent = node->parent;
-						}
-						delete adjnode;
+						STATS( ++statistics.closedHits; )
+						continue;
 					}
-					else
+					if ( distance[v] < 0 || d < distance[v] )
 					{
-						adjnode->g = node->g + 1;
-						adjnode->parent = node;
-						pq.push( adjnode );
+						STATS( if ( distance[v] >= 0 ) ++statistics.decreases; )
+						reach( v, d, u );
 					}
 				}
-				ht.add( node->key, node );
 			}
-
-			// Implement the search
-			if ( target[0] < 10 && target[1] > 0 )
-				return getPath( ht.find( target ) );
-
-			return getPath( nullptr );
+			STATS( statistics.seconds = std::chrono::duration<double>(
+					   std::chrono::steady_clock::now() - begin ).count(); )
+			return target < 0 ? std::vector<int>{} : getPath( target );
 		}
 
-	private:
+		/**
+		 * @brief
+		 * Cost of the shortest path from the source of the last run
+		 * @param target
+		 * Node id to look up
+		 * @return
+		 * The cost, or -1 when the node was not reached
+		*/
+		int getDistance( int target ) const
+		{
+			return target >= 0 && target < static_cast<int>( distance.size() ) ? distance[target] : -1;
+		}
 
 		/**
-		 * @brief 
-		 * Based on the pointer to the node ,
-		 retrieve all the nodes info and 
-		 return a container of characters 
-		 * @param pNode
-		 * Pointer to the nodes
+		 * @brief
+		 * Shortest path from the source of the last run to a node
+		 * @param target
+		 * Node id at the end of the path
 		 * @return
-		 * List of info to the nodes
+		 * List of node ids after the source, empty when unreachable
 		*/
-		std::vector<char> getPath( Node* pNode )
+		std::vector<int> getPath( int target ) const
 		{
-			std::vector<char> a{};
-			// Trace back to return a vector of moves (.info)
-			if ( pNode )
+			std::vector<int> path{};
+			if ( getDistance( target ) < 0 )
+				return path;
+
+			for ( ; target != source; target = parent[target] )
+				path.push_back( target );
+			std::reverse( path.begin(), path.end() );
+			return path;
+		}
+
+	private:
+
+		void reset()
+		{
+			size_t count = static_cast<size_t>( pGraph->size() );
+			if ( distance.size() != count )
 			{
-				while ( pNode->parent )
+				distance.assign( count, -1 );
+				parent.assign( count, -1 );
+				closed.assign( count, false );
+				open.resize( count );
+			}
+			else
+			{
+				for ( int id : touched )
 				{
-					a.push_back( pNode->info );
-					pNode = pNode->parent;
+					distance[id] = -1;
+					parent[id] = -1;
+					closed[id] = false;
 				}
-				std::reverse( a.begin(), a.end() );
+				open.clear();
 			}
-			return a;
+			touched.clear();
+			source = -1;
+		}
+
+		void reach( int id, int d, int from )
+		{
+			if ( distance[id] < 0 )
+			{
+				touched.push_back( id );
+				STATS( ++statistics.pushes; )
+			}
+			distance[id] = d;
+			parent[id] = from;
+			open.push( id, d );
+			STATS( statistics.peakOpen = std::max( statistics.peakOpen, open.size() ); )
 		}
 	};
 } // end namespace
@@ -14,10 +14,25 @@ void test7();
 void test8();
 void test9();
 void test10();
+void test11();
+void test12();
+void test13();
+void test14();
+void test15();
+void test16();
+void test17();
+void test18();
+void test19();
+void test20();
+void test21();
+void test22();
+void test23();
+void test24();
+void test25();
 
 int main(int argc, char* argv[])
 {
-    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10 };
+    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10, test11, test12, test13, test14, test15, test16, test17, test18, test19, test20, test21, test22, test23, test24, test25 };
     const int SIZE = sizeof(f) / sizeof(f[0]);
     int id = -1;
 
@@ -68,9 +83,10 @@ void test0()
     AI::Node n1{{ }, 0, '1' };
     AI::Node n2{{ }, 0, '2' };
     AI::Node n3{{ }, 0, '3' };
+    AI::NodePool pool;
 
     {
-        AI::Key v{ 1, 2, 3, 4, 5, 0, 7, 8, 6 };
+        AI::Key v{ 12, 345 };
         AI::HashTable root;
         AI::Node* actual = root.find(v);
         AI::Node* expected = nullptr;
@@ -79,9 +95,9 @@ void test0()
             std::cout << "Test 0_1 : Failed (" << std::endl << *actual << ')' << std::endl;
     }
     {
-        AI::Key v{ 1, 3, 2, 4, 5, 0, 7, 6, 8 };
+        AI::Key v{ 1, 3 };
         AI::HashTable root;
-        root.add(v, new AI::Node{{1, 2}, 3, '4' });
+        root.add(v, pool.make({1, 2}, 3, '4'));
         AI::Node* result1 = root.find(v);
         AI::Node* result2 = root.find(v); // Repeat
 
@@ -95,10 +111,10 @@ void test0()
     }
 
     {
-        AI::Key v{ 8, 3, 2, 4, 5, 0, 7, 6, 1 };
+        AI::Key v{ 8000, 3 };
         AI::HashTable root;
-        root.add(v, new AI::Node{{1, 2}, 3, '4' });
-        root.add(v, new AI::Node{{5, 6}, 7, '8' }); // Reset
+        root.add(v, pool.make({1, 2}, 3, '4'));
+        root.add(v, pool.make({5, 6}, 7, '8')); // Reset
         AI::Node* result = root.find(v);
 
         std::ostringstream os;
@@ -112,9 +128,9 @@ void test0()
 
     {
         AI::PriorityQueue q;
-        q.push(new AI::Node{{0, 0}, 3, 'S', &n1 });
-        q.push(new AI::Node{{1, 1}, 2, 'N', &n2 });
-        q.push(new AI::Node{{2, 2}, 5, 'E', &n3 });
+        q.push(pool.make({0, 0}, 3, 'S', &n1));
+        q.push(pool.make({1, 1}, 2, 'N', &n2));
+        q.push(pool.make({2, 2}, 5, 'E', &n3));
 
         std::ostringstream os;
         os << q;
@@ -128,9 +144,9 @@ void test0()
 
     {
         AI::PriorityQueue q;
-        q.push(new AI::Node{{0, 0}, 3, 'S', &n1 });
-        q.push(new AI::Node{{1, 1}, 2, 'N', &n2 });
-        q.push(new AI::Node{{2, 2}, 1, 'E', &n3 });
+        q.push(pool.make({0, 0}, 3, 'S', &n1));
+        q.push(pool.make({1, 1}, 2, 'N', &n2));
+        q.push(pool.make({2, 2}, 1, 'E', &n3));
 
         std::ostringstream os;
         os << q;
@@ -427,3 +443,638 @@ void test10()
     else
         std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
 }
+
+
+void test11()
+{
+    AI::Node n1{{ }, 0, '1' };
+    AI::NodePool pool;
+
+    AI::PriorityQueue q;
+    AI::Node* a = pool.make({0, 0}, 3, 'S', &n1);
+    AI::Node* b = pool.make({1, 1}, 5, 'N', &n1);
+    AI::Node* c = pool.make({2, 2}, 7, 'E', &n1);
+    q.push(a);
+    q.push(b);
+    q.push(c);
+
+    c->g = 1; // Decrease-key moves c to the front
+    q.decrease(c);
+
+    AI::Node* first = q.pop();
+
+    std::ostringstream os;
+    os << *first << "  " << q.contains(first) << q.contains(a) << "  " << q;
+
+    std::string actual = os.str();
+    std::string expected = "2,2 1 E 1  01  0,0 3 S 1  1,1 5 N 1  ";
+
+    std::cout << "Test 11 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Maps bigger than 10x10 and a target in the first column
+
+void test12()
+{
+    const int SIZE = 12;
+
+    int map[SIZE * SIZE] = {};
+    for (int j = 0; j < SIZE - 1; ++j)
+        map[j * SIZE + 6] = 1;
+
+    AI::GetMapAdjacents getAdjacents{map, SIZE};
+
+    AI::Dijkstras dijkstras(&getAdjacents);
+
+    std::vector<char> path = dijkstras.run({0, 11}, {0, 0});
+
+    // Replay the moves to check that they stay on empty cells
+    int j = 0, i = 11;
+    bool valid = true;
+    for (char move : path)
+    {
+        j += move == 'S' ? 1 : move == 'N' ? -1 : 0;
+        i += move == 'E' ? 1 : move == 'W' ? -1 : 0;
+        valid = valid && j >= 0 && j < SIZE && i >= 0 && i < SIZE && map[j * SIZE + i] != 1;
+    }
+
+    std::ostringstream os;
+    os << path.size() << ' ' << j << ',' << i << ' ' << valid;
+
+    std::string actual = os.str();
+    std::string expected = "33 0,0 1";
+
+    std::cout << "Test 12 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// A* with each heuristic finds the same path as Dijkstras
+
+void test13()
+{
+    int map[] = {
+        0, 1, 0, 0, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 0, 0, 1, 0
+    };
+
+    AI::GetMapAdjacents getAdjacents{map, 5};
+
+    std::ostringstream os;
+    os << AI::AStar<AI::Manhattan>(&getAdjacents).run({0, 0}, {4, 4}) << ' '
+       << AI::AStar<AI::Octile>(&getAdjacents).run({0, 0}, {4, 4}) << ' '
+       << AI::AStar<AI::Euclidean>(&getAdjacents).run({0, 0}, {4, 4}) << ' '
+       << AI::AStar<>(&getAdjacents).run({0, 0}, {0, 2}).size();
+
+    std::string actual = os.str();
+    std::string path = "S,S,S,S,E,E,N,N,N,N,E,E,S,S,S,S";
+    std::string expected = path + ' ' + path + ' ' + path + " 10";
+
+    std::cout << "Test 13 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Jump Point Search and JPS+ expand their jumps into single moves
+
+void test14()
+{
+    int map[] = {
+        0, 1, 0, 0, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 0, 0, 1, 0
+    };
+
+    AI::GetMapAdjacents getAdjacents{map, 5};
+
+    std::ostringstream os;
+    os << AI::JumpPointSearch(&getAdjacents).run({0, 0}, {4, 4}) << ' '
+       << AI::JumpPointSearchPlus(&getAdjacents).run({0, 0}, {4, 4}) << ' '
+       << AI::JumpPointSearchPlus(&getAdjacents).run({4, 4}, {4, 4}).size();
+
+    std::string actual = os.str();
+    std::string path = "S,S,S,S,E,E,N,N,N,N,E,E,S,S,S,S";
+    std::string expected = path + ' ' + path + " 0";
+
+    std::cout << "Test 14 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Bidirectional search meets in the middle with the same path
+
+void test15()
+{
+    int map[] = {
+        0, 1, 0, 0, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 0, 0, 1, 0
+    };
+
+    AI::GetMapAdjacents getAdjacents{map, 5};
+
+    AI::BidirectionalDijkstras dijkstras(&getAdjacents);
+
+    std::ostringstream os;
+    os << dijkstras.run({0, 0}, {4, 4}) << ' ' << dijkstras.run({4, 4}, {0, 0}).size()
+       << ' ' << dijkstras.run({0, 0}, {0, 0}).size() << ' ' << dijkstras.run({0, 0}, {30, 30}).size();
+
+    std::string actual = os.str();
+    std::string expected = "S,S,S,S,E,E,N,N,N,N,E,E,S,S,S,S 16 0 0";
+
+    std::cout << "Test 15 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// One distance field answers many path and next step queries
+
+void test16()
+{
+    int map[] = {
+        0, 1, 0, 0, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 0, 0, 1, 0
+    };
+
+    AI::GetMapAdjacents getAdjacents{map, 5};
+
+    AI::DistanceField field = AI::Dijkstras(&getAdjacents).field({0, 0});
+
+    std::ostringstream os;
+    os << field.getPath({4, 4}) << ' ' << field.getPath({0, 2}) << ' '
+       << field.getDistance({4, 4}) << ' ' << field.getDistance({0, 1}) << ' '
+       << field.nextStep({4, 4}) << field.nextStep({0, 4}) << field.nextStep({4, 0})
+       << '[' << field.nextStep({0, 0}) << ']';
+
+    std::string actual = os.str();
+    std::string expected = "S,S,S,S,E,E,N,N,N,N,E,E,S,S,S,S S,S,S,S,E,E,N,N,N,N 160 -1 NWN[ ]";
+
+    std::cout << "Test 16 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Hierarchical search on 4x4 clusters, before and after a map edit
+
+void test17()
+{
+    const int SIZE = 12;
+
+    int map[SIZE * SIZE] = {};
+    for (int j = 0; j < SIZE - 1; ++j)
+        map[j * SIZE + 6] = 1;
+
+    AI::GetMapAdjacents getAdjacents{map, SIZE};
+
+    AI::HierarchicalPathfinder hpa(&getAdjacents, 4);
+
+    std::ostringstream os;
+    os << hpa.run({0, 0}, {0, 11}).size() << ' ';
+
+    // Open a door at the top of the wall, the path gets much shorter
+    map[0 * SIZE + 6] = 0;
+    hpa.update({0, 6});
+    std::vector<char> path = hpa.run({0, 0}, {0, 11});
+
+    // Replay the moves to check that they stay on empty cells
+    int j = 0, i = 0;
+    bool valid = true;
+    for (char move : path)
+    {
+        j += move == 'S' ? 1 : move == 'N' ? -1 : 0;
+        i += move == 'E' ? 1 : move == 'W' ? -1 : 0;
+        valid = valid && j >= 0 && j < SIZE && i >= 0 && i < SIZE && map[j * SIZE + i] != 1;
+    }
+    os << (path.size() < 20) << ' ' << j << ',' << i << ' ' << valid << ' '
+       << hpa.run({0, 0}, {5, 5}).size();
+
+    std::string actual = os.str();
+    std::string expected = "33 1 0,11 1 10";
+
+    std::cout << "Test 17 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// A batch of queries over a worker pool matches one search per query
+
+void test18()
+{
+    const int SIZE = 12;
+
+    int map[SIZE * SIZE] = {};
+    for (int j = 0; j < SIZE - 1; ++j)
+        map[j * SIZE + 6] = 1;
+    map[5 * SIZE + 3] = 1;
+
+    AI::GetMapAdjacents getAdjacents{map, SIZE};
+
+    std::vector<std::pair<AI::Key, AI::Key>> queries;
+    for (int q = 0; q < 40; ++q)
+        queries.push_back({{q % SIZE, q * 7 % SIZE}, {q * 5 % SIZE, (q + 3) % SIZE}});
+    queries.push_back({{0, 0}, {30, 30}});
+    queries.push_back({{11, 0}, {11, 11}});
+
+    AI::PathService<> service(&getAdjacents, 3);
+    AI::AStar<AI::Zero> astar(&getAdjacents);
+
+    // The second batch runs on the scratch left by the first
+    std::vector<std::vector<char>> first = service.run(queries);
+    std::vector<std::vector<char>> second = service.run(queries);
+
+    bool same = first.size() == queries.size() && first == second;
+    for (size_t q = 0; q < queries.size() && same; ++q)
+        same = first[q] == astar.run(queries[q].first, queries[q].second);
+
+    std::ostringstream os;
+    os << service.threads() << ' ' << same << ' ' << first[0].size() << ' '
+       << first[1].size() << ' ' << first[40].size() << ' ' << first[41].size() << ' '
+       << service.run({}).size();
+
+    std::string actual = os.str();
+    std::string expected = "3 1 3 19 0 11 0";
+
+    std::cout << "Test 18 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Domain that only provides the heap allocating interface: a row of keys
+// from 0,0 to 0,5 where every key links to its neighbours
+
+struct GetRowAdjacents : AI::GetAdjacents
+{
+    std::vector<AI::Node*> operator()(AI::Key key)
+    {
+        std::vector<AI::Node*> list;
+        if (key.i > 0)
+            list.push_back(new AI::Node{{0, key.i - 1}, 10, 'W'});
+        if (key.i < 5)
+            list.push_back(new AI::Node{{0, key.i + 1}, 10, 'E'});
+        return list;
+    }
+};
+
+// The pool hands back released nodes first and reuses its chunks after
+// a clear, searches on either kind of domain release all their nodes
+
+void test19()
+{
+    AI::NodePool pool;
+    AI::Node* a = pool.make({1, 1}, 3, 'S');
+    AI::Node* b = pool.make();
+    pool.make();
+    pool.release(b);
+    AI::Node* c = pool.make({2, 2});
+
+    std::ostringstream os;
+    os << (b == c) << ' ' << pool.size() << ' ' << *a << ' ';
+
+    for (int n = 0; n < 3000; ++n)
+        pool.make();
+    size_t capacity = pool.capacity();
+    pool.clear();
+    os << (pool.make() == a) << ' ' << pool.size() << ' ' << capacity << ' ';
+
+    int map[] = {
+        0, 1, 0, 0, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 0, 0, 1, 0
+    };
+    AI::GetMapAdjacents getAdjacents{map, 5};
+    GetRowAdjacents getRowAdjacents;
+
+    os << AI::Dijkstras(&getAdjacents).run({0, 0}, {4, 4}).size() << ' '
+       << AI::Dijkstras(&getRowAdjacents).run({0, 4}, {0, 1}) << ' '
+       << AI::BidirectionalDijkstras(&getRowAdjacents).run({0, 0}, {0, 5});
+
+    std::string actual = os.str();
+    std::string expected = "1 3 1,1 3 S 1 1 3072 16 W,W,W E,E,E,E,E";
+
+    std::cout << "Test 19 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Terrain weights and diagonal moves, searched with a binary heap and with
+// Dial's bucket queue
+
+void test20()
+{
+    int map[] = {
+        0, 0, 0, 0, 0,
+        0, 3, 3, 3, 0,
+        0, 3, 1, 0, 0,
+        0, 3, 3, 3, 0,
+        0, 0, 0, 0, 0
+    };
+
+    AI::GetMapAdjacents straight{map, 5};
+    AI::GetMapAdjacents diagonal{map, 5, true};
+
+    std::vector<AI::Node*> adjacents = diagonal({2, 3});
+
+    std::ostringstream os;
+    os << adjacents << "  " << straight.maxCost() << ' ' << diagonal.maxCost() << "  "
+       << AI::Dijkstras(&straight).run({2, 3}, {4, 0}) << ' '
+       << AI::Dial<>(&straight).run({2, 3}, {4, 0}) << ' '
+       << AI::Dial<AI::Octile>(&diagonal).run({2, 3}, {4, 0}) << ' '
+       << AI::Dijkstras(&diagonal).field({2, 3}).getDistance({4, 0});
+
+    for (auto a : adjacents)
+        delete a;
+
+    // One Dial for several queries, its ring grows with a heavier cell
+    AI::Dial<> dial(&straight);
+    os << "  " << dial.run({2, 3}, {4, 0}) << ' ';
+    map[4 * 5 + 1] = 9;
+    straight.update({4, 1});
+    os << straight.maxCost() << ' ' << dial.run({2, 3}, {4, 0}) << ' '
+       << AI::Dijkstras(&straight).field({2, 3}).getDistance({4, 0});
+
+    // A cell made heavier without telling the map, the ring still holds
+    // the moves that cost more than maxCost
+    map[4 * 5 + 1] = 40;
+    os << "  " << straight.maxCost() << ' ' << dial.run({2, 3}, {4, 1}) << ' '
+       << AI::Dijkstras(&straight).field({2, 3}).getDistance({4, 1});
+
+    std::string actual = os.str();
+    std::string expected = "2,4 10 E  1,3 30 N  3,3 30 S  1,4 14 9  3,4 14 3  30 42  "
+                           "E,S,S,W,W,W,W E,S,S,W,W,W,W 3,1,W,W,W 58  E,S,S,W,W,W,W 90 E,N,N,W,W,W,W,S,S,S,S 110  "
+                           "90 E,S,S,W,W,W 450";
+
+    std::cout << "Test 20 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// D* Lite repairs its search after map edits and a moving start
+
+void test21()
+{
+    const int SIZE = 12;
+
+    int map[SIZE * SIZE] = {};
+    for (int j = 0; j < SIZE - 1; ++j)
+        map[j * SIZE + 6] = 1;
+
+    AI::GetMapAdjacents getAdjacents{map, SIZE};
+
+    AI::DStarLite<AI::Manhattan> planner(&getAdjacents);
+
+    std::ostringstream os;
+    os << planner.run({0, 0}, {0, 11}).size() << ' ';
+    size_t planned = planner.expansions();
+
+    // Open a door at the top of the wall, only the cells near it change
+    map[0 * SIZE + 6] = 0;
+    planner.update({0, 6});
+    os << planner.run({0, 0}, {0, 11}) << ' ' << (planner.expansions() < planned / 2) << ' ';
+
+    // Walk two steps, then close the door behind a heavy cell
+    map[0 * SIZE + 6] = 1;
+    planner.update({0, 6});
+    map[11 * SIZE + 6] = 5;
+    planner.update({11, 6});
+    os << planner.run({0, 2}, {0, 11}).size() << ' '
+       << AI::Dijkstras(&getAdjacents).field({0, 2}).getDistance({0, 11}) << ' ';
+
+    // Wall the target in
+    map[1 * SIZE + 11] = map[0 * SIZE + 10] = 1;
+    planner.update({1, 11});
+    planner.update({0, 10});
+    os << planner.run({0, 2}, {0, 11}).size();
+
+    std::string actual = os.str();
+    std::string expected = "33 E,E,E,E,E,E,E,E,E,E,E 1 31 350 0";
+
+    std::cout << "Test 21 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Search counters and the expansion trace
+
+void test22()
+{
+    int map[] = {
+        0, 1, 0, 0, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 1, 0, 1, 0,
+        0, 0, 0, 1, 0
+    };
+
+    AI::GetMapAdjacents getAdjacents{map, 5};
+
+    AI::Dijkstras dijkstras(&getAdjacents);
+    AI::AStar<> astar(&getAdjacents);
+
+    std::ostringstream trace;
+    dijkstras.trace(&trace);
+    dijkstras.run({0, 0}, {4, 4});
+    const AI::SearchStats& stats = dijkstras.stats();
+
+    std::string dump = trace.str();
+    std::string first = dump.substr(0, dump.find('\n'));
+    size_t lines = std::count(dump.begin(), dump.end(), '\n');
+
+    std::ostringstream os;
+    os << stats.expanded << ' ' << stats.pushes << ' ' << stats.pops << ' ' << stats.decreases << ' '
+       << stats.closedHits << ' ' << stats.peakOpen << ' ' << (stats.seconds >= 0.0) << ' '
+       << lines << " [" << first << "] ";
+
+    astar.run({0, 0}, {0, 2});
+    os << astar.stats().expanded << ' ' << astar.stats().pops << ' ';
+
+    // The engines with their own loops count the same way
+    AI::BidirectionalDijkstras bidirectional(&getAdjacents);
+    AI::JumpPointSearch jps(&getAdjacents);
+    AI::HierarchicalPathfinder hpa(&getAdjacents, 4);
+    bidirectional.run({0, 0}, {4, 4});
+    jps.run({0, 0}, {4, 4});
+    hpa.run({0, 0}, {4, 4});
+    os << bidirectional.stats().expanded << ' ' << bidirectional.stats().pushes << ' '
+       << jps.stats().expanded << ' ' << jps.stats().pushes << ' ' << (hpa.stats().expanded > 0);
+
+    std::string actual = os.str();
+#ifdef NSTATS
+    std::string expected = "0 0 0 0 0 0 1 0 [] 0 0 0 0 0 0 0"; // compiled out
+#else
+    std::string expected = "17 17 17 0 16 1 1 17 [0,0 0 0] 10 11 16 18 5 6 1";
+#endif
+
+    std::cout << "Test 22 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+std::ostream& operator<<(std::ostream& os, const std::vector<int>& rhs)
+{
+    for (auto it = rhs.begin(); it != rhs.end(); ++it)
+        os << *it << (it + 1 != rhs.end() ? "," : "");
+    return os;
+}
+
+// Dijkstra on a graph in compressed sparse row form
+
+void test23()
+{
+    AI::Graph graph = AI::Graph::fromEdges(7, {
+        {0, 1, 7}, {0, 2, 9}, {0, 5, 14}, {1, 2, 10}, {1, 3, 15},
+        {2, 3, 11}, {2, 5, 2}, {3, 4, 6}, {5, 4, 9}, {7, 1, 1}
+    });
+
+    AI::GraphDijkstras dijkstras(&graph);
+
+    std::ostringstream os;
+    os << graph.size() << ' ' << graph.edges() << ' ';
+    os << dijkstras.run(0, 4) << ' ' << dijkstras.getDistance(4) << ' ';
+
+    dijkstras.run(0, -1);
+    for (int id = 0; id < graph.size(); ++id)
+        os << dijkstras.getDistance(id) << ' ';
+    os << dijkstras.getPath(3) << ' ' << dijkstras.getPath(6).size() << ' ';
+
+    os << dijkstras.run(3, 0).size() << ' ' << dijkstras.getPath(4) << ' ' << dijkstras.getDistance(1);
+
+    std::string actual = os.str();
+    std::string expected = "7 9 2,5,4 20 0 7 9 20 20 11 -1 2,3 0 0 4 -1";
+
+    std::cout << "Test 23 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// On a weighted map with diagonal moves the way back is not the way there
+// turned around, the next steps follow the cheapest way back
+
+void test24()
+{
+    int map[] = {
+        0, 5, 0, 0, 0,
+        0, 0, 0, 0, 0,
+        0, 0, 0, 5, 5,
+        0, 0, 0, 5, 0,
+        0, 0, 0, 5, 0
+    };
+
+    AI::GetMapAdjacents getAdjacents{map, 5, true};
+
+    AI::DistanceField field = AI::Dijkstras(&getAdjacents).field({0, 0});
+
+    std::ostringstream os;
+    for (char move : field.getPath({4, 4}))
+        os << move;
+    os << ' ' << field.getDistance({4, 4}) << ' ' << field.getDistanceBack({4, 4}) << ' ';
+
+    // Walk the next steps back to the source and add up what they cost
+    int j = 4, i = 4, cost = 0;
+    for (char move = field.nextStep({j, i}); move != ' '; move = field.nextStep({j, i}))
+    {
+        int dj = move == 'N' || move == '7' || move == '9' ? -1 : move == 'S' || move == '1' || move == '3' ? 1 : 0;
+        int di = move == 'W' || move == '7' || move == '1' ? -1 : move == 'E' || move == '9' || move == '3' ? 1 : 0;
+        j += dj;
+        i += di;
+        cost += (dj && di ? 14 : 10) * std::max(map[j * 5 + i], 1);
+        os << move;
+    }
+    os << ' ' << j << ',' << i << ' ' << cost << ' ' << field.getDistanceBack({0, 0});
+
+    std::string actual = os.str();
+    std::string expected = "S33E3 102 102 W777N 0,0 102 0";
+
+    std::cout << "Test 24 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Hierarchical search on a weighted map with diagonal moves, the links into
+// the target cost the moves from the entrances to it, not from it
+
+void test25()
+{
+    const int SIZE = 8;
+
+    int map[SIZE * SIZE] = {
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 1, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 5, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 5, 0, 0,
+        0, 5, 0, 0, 0, 0, 5, 0,
+        0, 0, 0, 5, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0
+    };
+
+    AI::GetMapAdjacents getAdjacents{map, SIZE, true};
+
+    AI::HierarchicalPathfinder hpa(&getAdjacents, 4);
+
+    std::vector<char> path = hpa.run({0, 0}, {7, 7});
+
+    // Replay the moves and add up what they cost
+    std::ostringstream os;
+    int j = 0, i = 0, cost = 0;
+    for (char move : path)
+    {
+        int dj = move == 'N' || move == '7' || move == '9' ? -1 : move == 'S' || move == '1' || move == '3' ? 1 : 0;
+        int di = move == 'W' || move == '7' || move == '1' ? -1 : move == 'E' || move == '9' || move == '3' ? 1 : 0;
+        j += dj;
+        i += di;
+        cost += (dj && di ? 14 : 10) * std::max(map[j * SIZE + i], 1);
+        os << move;
+    }
+    os << ' ' << j << ',' << i << ' ' << cost;
+
+    std::string actual = os.str();
+    std::string expected = "E33E3SS33 7,7 150";
+
+    std::cout << "Test 25 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
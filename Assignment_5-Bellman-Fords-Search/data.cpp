@@ -1,5 +1,57 @@
 #include "data.h"
+#include <sstream>
+#include <string>
 
 namespace AI
 {
+    bool Graph::read(std::istream& is, Graph& graph)
+    {
+        std::vector<std::array<int, 3>> edges;
+        int count = -1;
+        bool dimacs = false;
+        std::string line;
+
+        while (std::getline(is, line))
+        {
+            std::istringstream fields(line);
+            std::string first;
+            if (!(fields >> first) || first == "c" || first[0] == '#')
+                continue;
+
+            std::array<int, 3> edge{};
+            if (first == "p")
+            {
+                std::string problem;
+                if (count >= 0 || !(fields >> problem >> count))
+                    return false;
+                dimacs = true;
+            }
+            else if (first == "a")
+            {
+                if (!dimacs || !(fields >> edge[0] >> edge[1] >> edge[2]))
+                    return false;
+                edges.push_back({ edge[0] - 1, edge[1] - 1, edge[2] });
+            }
+            else if (dimacs)
+                return false;
+            else
+            {
+                std::istringstream numbers(line);
+                if (count < 0)
+                {
+                    if (!(numbers >> count))
+                        return false;
+                }
+                else if (numbers >> edge[0] >> edge[1] >> edge[2])
+                    edges.push_back(edge);
+                else
+                    return false;
+            }
+        }
+
+        if (count < 0)
+            return false;
+        graph = fromEdges(count, edges);
+        return true;
+    }
 } // end namespace
\ No newline at end of file
@@ -1,7 +1,176 @@
 #ifndef DATA_H
 #define DATA_H
 
+#include <istream>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <climits>
+#include <mutex>
+#include <condition_variable>
+
 namespace AI
-{} // end namespace
+{
+    // Directed weighted graph in compressed sparse row form: the edges
+    // leaving vertex j are targets[offsets[j]] to targets[offsets[j + 1] - 1],
+    // with their weights at the same positions. The edges of each vertex are
+    // sorted by target, so a sweep over them visits the edges in the same
+    // order as a sweep over a row of the cost matrix
+    class Graph
+    {
+    public:
+        std::vector<int> offsets; // vertex count + 1 entries
+        std::vector<int> targets;
+        std::vector<int> weights;
+
+        Graph()
+            : offsets(1, 0)
+            , targets{}
+            , weights{}
+        {
+        }
+
+        // Build from {from, to, weight} triples. Edges with a vertex outside
+        // 0 to count - 1 or a weight of INT_MAX (no edge, as in the matrix)
+        // are dropped, of parallel edges only the cheapest is kept
+        static Graph fromEdges(int count, std::vector<std::array<int, 3>> edges)
+        {
+            auto dropped = [count](const std::array<int, 3>& edge)
+            {
+                return edge[0] < 0 || edge[0] >= count || edge[1] < 0 || edge[1] >= count
+                    || edge[2] == INT_MAX;
+            };
+            edges.erase(std::remove_if(edges.begin(), edges.end(), dropped), edges.end());
+            std::sort(edges.begin(), edges.end());
+
+            Graph graph;
+            graph.offsets.assign(static_cast<size_t>(std::max(count, 0)) + 1, 0);
+            for (size_t e = 0; e < edges.size(); ++e)
+            {
+                // Sorted by weight too, the first of parallel edges is the cheapest
+                if (e > 0 && edges[e][0] == edges[e - 1][0] && edges[e][1] == edges[e - 1][1])
+                    continue;
+                ++graph.offsets[edges[e][0] + 1];
+                graph.targets.push_back(edges[e][1]);
+                graph.weights.push_back(edges[e][2]);
+            }
+            for (int j = 0; j < count; ++j)
+                graph.offsets[j + 1] += graph.offsets[j];
+            return graph;
+        }
+
+        // Build from a count * count cost matrix, INT_MAX for no edge
+        static Graph fromMatrix(const int* matrix, int count)
+        {
+            Graph graph;
+            graph.offsets.assign(static_cast<size_t>(std::max(count, 0)) + 1, 0);
+            for (int j = 0; j < count; ++j)
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    if (matrix[j * count + i] != INT_MAX)
+                    {
+                        graph.targets.push_back(i);
+                        graph.weights.push_back(matrix[j * count + i]);
+                    }
+                }
+                graph.offsets[j + 1] = static_cast<int>(graph.targets.size());
+            }
+            return graph;
+        }
+
+        // Read a graph from a text stream in one of two formats:
+        // - the number of vertices, then a "from to weight" line per edge,
+        //   vertices counted from 0
+        // - DIMACS shortest path files: "p sp vertices edges", then an
+        //   "a from to weight" line per edge, vertices counted from 1
+        // Lines starting with c or # are comments. The graph is left
+        // untouched when the stream cannot be parsed
+        static bool read(std::istream& is, Graph& graph);
+
+        // The same graph with every edge reversed, the edges entering
+        // vertex i become the edges leaving it, still sorted by vertex
+        Graph transpose() const
+        {
+            Graph graph;
+            graph.offsets.assign(offsets.size(), 0);
+            graph.targets.resize(targets.size());
+            graph.weights.resize(weights.size());
+
+            for (int i : targets)
+                ++graph.offsets[i + 1];
+            for (int i = 0; i < size(); ++i)
+                graph.offsets[i + 1] += graph.offsets[i];
+
+            std::vector<int> next(graph.offsets.begin(), graph.offsets.end() - 1);
+            for (int j = 0; j < size(); ++j)
+            {
+                for (int e = begin(j); e < end(j); ++e)
+                {
+                    int slot = next[targets[e]]++;
+                    graph.targets[slot] = j;
+                    graph.weights[slot] = weights[e];
+                }
+            }
+            return graph;
+        }
+
+        int size() const
+        {
+            return static_cast<int>(offsets.size()) - 1;
+        }
+
+        int edges() const
+        {
+            return offsets.back();
+        }
+
+        int begin(int j) const
+        {
+            return offsets[j];
+        }
+
+        int end(int j) const
+        {
+            return offsets[j + 1];
+        }
+    };
+
+    // Reusable meeting point for a fixed number of threads: wait() returns
+    // once every thread has called it, then the barrier is ready again
+    class Barrier
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        int count;
+        int waiting;
+        size_t generation;
+
+    public:
+        explicit Barrier(int count)
+            : mutex{}
+            , condition{}
+            , count{ count }
+            , waiting{ 0 }
+            , generation{ 0 }
+        {
+        }
+
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            size_t arrived = generation;
+            if (++waiting == count)
+            {
+                waiting = 0;
+                ++generation;
+                condition.notify_all();
+            }
+            else
+                condition.wait(lock, [this, arrived] { return generation != arrived; });
+        }
+    };
+
+} // end namespace
 
-#endif
\ No newline at end of file
+#endif
@@ -12,5 +12,75 @@ Implement the Bellman-Ford's algorithms for path searching on a graph with negat
 
 #include "functions.h"
 
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
 namespace AI
-{} // end namespace
\ No newline at end of file
+{
+	int relaxRow( const int* row, int d, int j, int* distance, int* predecessor, int first, int last )
+	{
+		int i = first;
+		int relaxations = 0;
+
+#if defined(__AVX2__)
+		const __m256i source = _mm256_set1_epi32( d );
+		const __m256i none = _mm256_set1_epi32( inf );
+		const __m256i from = _mm256_set1_epi32( j );
+		__m256i count = _mm256_setzero_si256();
+		for ( ; i + 8 <= last; i += 8 )
+		{
+			__m256i cost = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( row + i ) );
+			__m256i current = _mm256_loadu_si256( reinterpret_cast< __m256i* >( distance + i ) );
+			__m256i parent = _mm256_loadu_si256( reinterpret_cast< __m256i* >( predecessor + i ) );
+
+			// inf + d stays inf
+			__m256i candidate = _mm256_blendv_epi8( _mm256_add_epi32( source, cost ), none,
+													_mm256_cmpeq_epi32( cost, none ) );
+			__m256i better = _mm256_cmpgt_epi32( current, candidate );
+
+			_mm256_storeu_si256( reinterpret_cast< __m256i* >( distance + i ),
+								 _mm256_blendv_epi8( current, candidate, better ) );
+			_mm256_storeu_si256( reinterpret_cast< __m256i* >( predecessor + i ),
+								 _mm256_blendv_epi8( parent, from, better ) );
+			count = _mm256_sub_epi32( count, better );	// better lanes are -1
+		}
+		alignas( 32 ) int lanes[8];
+		_mm256_store_si256( reinterpret_cast< __m256i* >( lanes ), count );
+		for ( int lane : lanes )
+			relaxations += lane;
+#elif defined(__SSE2__) || defined(_M_X64)
+		const __m128i source = _mm_set1_epi32( d );
+		const __m128i none = _mm_set1_epi32( inf );
+		const __m128i from = _mm_set1_epi32( j );
+		__m128i count = _mm_setzero_si128();
+		for ( ; i + 4 <= last; i += 4 )
+		{
+			__m128i cost = _mm_loadu_si128( reinterpret_cast< const __m128i* >( row + i ) );
+			__m128i current = _mm_loadu_si128( reinterpret_cast< __m128i* >( distance + i ) );
+			__m128i parent = _mm_loadu_si128( reinterpret_cast< __m128i* >( predecessor + i ) );
+
+			// inf + d stays inf, SSE2 has no blend so masks select the lanes
+			__m128i missing = _mm_cmpeq_epi32( cost, none );
+			__m128i candidate = _mm_or_si128( _mm_and_si128( missing, none ),
+											  _mm_andnot_si128( missing, _mm_add_epi32( source, cost ) ) );
+			__m128i better = _mm_cmplt_epi32( candidate, current );
+
+			_mm_storeu_si128( reinterpret_cast< __m128i* >( distance + i ),
+							  _mm_or_si128( _mm_and_si128( better, candidate ), _mm_andnot_si128( better, current ) ) );
+			_mm_storeu_si128( reinterpret_cast< __m128i* >( predecessor + i ),
+							  _mm_or_si128( _mm_and_si128( better, from ), _mm_andnot_si128( better, parent ) ) );
+			count = _mm_sub_epi32( count, better );	// better lanes are -1
+		}
+		alignas( 16 ) int lanes[4];
+		_mm_store_si128( reinterpret_cast< __m128i* >( lanes ), count );
+		for ( int lane : lanes )
+			relaxations += lane;
+#endif
+
+		// The remaining entries, or the whole row without SIMD
+		for ( ; i < last; i++ )
+			relaxations += relaxEntry( row[i], d, j, distance[i], predecessor[i] );
+		return relaxations;
+	}
+} // end namespace
\ No newline at end of file
@@ -19,6 +19,10 @@ Implement the Bellman-Ford's algorithms for path searching on a graph with negat
 #include <climits>
 #include <algorithm>
 #include <memory>
+#include <deque>
+#include <thread>
+#include <type_traits>
+#include <numeric>
 
 #include "data.h"
 
@@ -29,15 +33,81 @@ namespace AI
 	const int null = -1;
 	const int inf = INT_MAX;
 
+	/**
+	 * @brief
+	 * Relax the entries first to last - 1 of one row of a cost matrix
+	 without branches: AVX2 or SSE2 lanes when the target has them, a
+	 plain loop otherwise. An inf cost stays inf whatever the distance.
+	 * @param row
+	 * Costs of the edges leaving vertex j.
+	 * @param d
+	 * Distance of vertex j, not inf.
+	 * @param j
+	 * @param distance
+	 * @param predecessor
+	 * @param first
+	 * @param last
+	 * @return
+	 * Number of distances that got shorter.
+	*/
+	int relaxRow( const int* row, int d, int j, int* distance, int* predecessor, int first, int last );
+
+	/**
+	 * @brief
+	 * Branchless relaxation of one matrix entry, the scalar step of relaxRow
+	 * @param cost
+	 * Cost of the edge j -> i, inf for none.
+	 * @param d
+	 * Distance of vertex j, not inf.
+	 * @param j
+	 * @param distance
+	 * Distance of vertex i.
+	 * @param predecessor
+	 * Predecessor of vertex i.
+	 * @return
+	 * 1 when the distance got shorter, 0 otherwise.
+	*/
+	inline int relaxEntry( int cost, int d, int j, int& distance, int& predecessor )
+	{
+		int candidate = cost == inf ? inf : d + cost;
+		bool better = candidate < distance;
+		distance = better ? candidate : distance;
+		predecessor = better ? j : predecessor;
+		return better;
+	}
+
 	// An implementation of the Bellman-Ford algorithm. 
 	// The algorithm finds the shortest path between a
 	// starting node and all other nodes in the graph. 
 	// The algorithm also detects negative cycles.
+	// The graph is either a dense cost matrix or, for sparse graphs, a
+	// Graph whose passes only look at the edges that exist.
+	// SIZE fixes the number of vertices at compile time, small sizes keep
+	// their arrays in the object. With SIZE 0 the number of vertices is
+	// taken at run time, from the constructor or from the graph.
 	template<int SIZE = 0>
 	class BellmanFord
 	{
+		// Sizes up to this many vertices are stored inline
+		static constexpr int INLINE = 256;
+		// and up to this many relaxed by fully unrolled loops, larger
+		// rows are faster through the SIMD kernel
+		static constexpr int UNROLL = 8;
+		using Storage = typename std::conditional<( SIZE > 0 && SIZE <= INLINE ),
+			std::array<int, ( SIZE > 0 ? SIZE : 1 )>, std::vector<int>>::type;
+
+		int vertices;
+		Storage distances;
+		Storage predecessors;
+		std::vector<int> negativeCycle; // found by the last runTree or update
+		int source; // starting vertex of the distances, null when they are not valid
+		Graph reversed; // incoming edges for update, built on first use
+		std::vector<bool> pending; // scratch of update, all false between calls
+		std::vector<int> lengths; // scratch of update
+
 	public:
 		int* matrix; // the cost adjacency matrix
+		Graph* graph; // the edges, used instead of matrix when set
 		int* distance;
 		int* predecessor;
 
@@ -47,22 +117,48 @@ namespace AI
 		 stores the distance of all vertices from the initial vertex.
 		 * @param matrix 
 		 * Initialised with the pointer to an array of int matrix.
+		 * @param size
+		 * Number of vertices, only read when SIZE is 0.
+		*/
+		BellmanFord( int* matrix = nullptr, int size = SIZE )
+			: vertices{ SIZE > 0 ? SIZE : std::max( size, 0 ) }, distances{}, predecessors{}, negativeCycle{}
+			, source{ null }, reversed{}, pending{}, lengths{}
+			, matrix{ matrix }, graph{ nullptr }, distance{ nullptr }, predecessor{ nullptr }
+		{
+			allocate();
+		}
+
+		/**
+		 * @brief
+		 * Sparse mode: a pass relaxes the edges of the graph only, so it
+		 costs O(E) instead of O(SIZE^2). The results are the same as with
+		 the cost matrix of the graph.
+		 * @param graph
+		 * Graph of SIZE vertices, or of any size when SIZE is 0. It must
+		 outlive the object. update writes the new weights into it, once
+		 it is used the weights must only change through update.
 		*/
-		BellmanFord( int* matrix = nullptr )
-			: matrix{ matrix }, distance{ nullptr }, predecessor{ nullptr }
+		BellmanFord( Graph* graph )
+			: vertices{ SIZE > 0 ? SIZE : graph->size() }, distances{}, predecessors{}, negativeCycle{}
+			, source{ null }, reversed{}, pending{}, lengths{}
+			, matrix{ nullptr }, graph{ graph }, distance{ nullptr }, predecessor{ nullptr }
 		{
-			predecessor = new int[SIZE];
-			distance = new int[SIZE];
+			allocate();
 		}
-		
+
+		// distance and predecessor point into the object
+		BellmanFord( const BellmanFord& ) = delete;
+		BellmanFord& operator=( const BellmanFord& ) = delete;
+
 		/**
 		 * @brief
-		 * Free all allocated pointer.
+		 * Number of vertices
+		 * @return
+		 * SIZE, or the size given at run time when SIZE is 0.
 		*/
-		~BellmanFord()
+		int size() const
 		{
-			delete[] distance;
-			delete[] predecessor;
+			return SIZE > 0 ? SIZE : vertices;
 		}
 
 		/**
@@ -75,42 +171,398 @@ namespace AI
 		*/
 		bool run( int starting = 0 )
 		{
-			if ( !matrix )
+			if ( !ready( starting ) )
 				return false;
 
 			// Initialize predecessor array which will be used in shortest path
 			// reconstruction after the algorithm has terminated.
-			std::fill_n( predecessor, SIZE, null );
+			std::fill_n( predecessor, size(), null );
 			// Initialize distances from src to all other vertices as INF
-			std::fill_n( distance, SIZE, inf );
+			std::fill_n( distance, size(), inf );
 			distance[starting] = 0;
+			source = null;
 
-			for ( int k = 0; k < SIZE - 1; k++ )
+			// With V vertices V - 1 passes find every shortest path, one
+			// more pass that still relaxes something proves a negative cycle
+			for ( int k = 0; k < size(); k++ )
 			{
-				int relaxations = 0;
-				for ( int j = 0; j < SIZE; j++ )
+				int relaxations = graph ? relaxSparse() : relaxDense();
+				// Stop when no more relaxation
+				if ( relaxations == 0 ) 
 				{
-					for ( int i = 0; i < SIZE; i++ )
+					// There is no negative cycles 
+					source = starting;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * @brief
+		 * Queue based variant (SPFA): only the edges leaving a vertex whose
+		 distance just got shorter are relaxed again, instead of every edge
+		 in every pass. The distances are the ones of run, on ties the
+		 predecessor may be another vertex on an equally short path.
+		 * Negative Cycle : each vertex counts the edges of the path that gave
+		 it its distance, a count of size() means the path repeats a vertex,
+		 which only a negative cycle can make shorter.
+		 * @param starting
+		 * @return
+		 * Returns false when negative cycles are found, and true otherwise.
+		*/
+		bool runQueue( int starting = 0 )
+		{
+			if ( !ready( starting ) )
+				return false;
+
+			std::fill_n( predecessor, size(), null );
+			std::fill_n( distance, size(), inf );
+			distance[starting] = 0;
+			source = null;
+
+			std::vector<int> length( size(), 0 );
+			std::vector<bool> queued( size(), false );
+			std::deque<int> queue{ starting };
+			queued[starting] = true;
+
+			bool cycle = false;
+			while ( !queue.empty() && !cycle )
+			{
+				int j = queue.front();
+				queue.pop_front();
+				queued[j] = false;
+
+				edgesFrom( j, [&]( int i, int cost )
+				{
+					if ( cycle || distance[j] + cost >= distance[i] )
+						return;
+
+					distance[i] = distance[j] + cost;
+					predecessor[i] = j;
+					length[i] = length[j] + 1;
+					if ( length[i] >= size() )
+						cycle = true;
+					else if ( !queued[i] )
 					{
-						if ( ( j != i ) &&
-							 ( distance[j] != inf ) &&
-							 ( matrix[i + ( j * SIZE )] != inf ) &&
-							 ( distance[j] + matrix[i + ( j * SIZE )] ) < distance[i] )
+						queue.push_back( i );
+						queued[i] = true;
+					}
+				} );
+			}
+			if ( !cycle )
+				source = starting;
+			return !cycle;
+		}
+
+		/**
+		 * @brief
+		 * Queue based variant with Tarjan's subtree disassembly: the
+		 shortest path tree is kept explicitly, and before a vertex gets a
+		 new parent its subtree is taken out of the tree, since the
+		 distances below it are out of date. Taken out vertices are not
+		 scanned until they get a shorter distance again.
+		 * Negative Cycle : when the new parent is in the subtree itself,
+		 the edge closes a cycle that just got shorter than nothing. It is
+		 reported at once instead of after size() passes, see getCycle.
+		 * @param starting
+		 * @return
+		 * Returns false when negative cycles are found, and true otherwise.
+		*/
+		bool runTree( int starting = 0 )
+		{
+			negativeCycle.clear();
+			if ( !ready( starting ) )
+				return false;
+
+			std::fill_n( predecessor, size(), null );
+			std::fill_n( distance, size(), inf );
+			distance[starting] = 0;
+			source = null;
+
+			// The tree as a list in preorder, a subtree is a vertex and the
+			// deeper vertices that follow it
+			std::vector<int> after( size(), null );
+			std::vector<int> before( size(), null );
+			std::vector<int> depth( size(), 0 );
+			std::vector<bool> inTree( size(), false );
+			inTree[starting] = true;
+
+			std::vector<bool> queued( size(), false );
+			std::deque<int> queue{ starting };
+			queued[starting] = true;
+
+			while ( !queue.empty() && negativeCycle.empty() )
+			{
+				int j = queue.front();
+				queue.pop_front();
+				queued[j] = false;
+				if ( !inTree[j] )
+					continue;
+
+				edgesFrom( j, [&]( int i, int cost )
+				{
+					if ( !negativeCycle.empty() || distance[j] + cost >= distance[i] )
+						return;
+
+					if ( inTree[i] )
+					{
+						// Take the subtree of i out of the list
+						int last = i;
+						for ( int w = after[i]; w != null && depth[w] > depth[i]; w = after[w] )
+						{
+							if ( w == j )
+							{
+								for ( int v = j; v != i; v = predecessor[v] )
+									negativeCycle.push_back( v );
+								negativeCycle.push_back( i );
+								std::reverse( negativeCycle.begin(), negativeCycle.end() );
+								return;
+							}
+							inTree[w] = false;
+							last = w;
+						}
+						if ( before[i] != null )
+							after[before[i]] = after[last];
+						if ( after[last] != null )
+							before[after[last]] = before[i];
+					}
+
+					distance[i] = distance[j] + cost;
+					predecessor[i] = j;
+
+					// First child of j
+					inTree[i] = true;
+					depth[i] = depth[j] + 1;
+					before[i] = j;
+					after[i] = after[j];
+					if ( after[j] != null )
+						before[after[j]] = i;
+					after[j] = i;
+
+					if ( !queued[i] )
+					{
+						queue.push_back( i );
+						queued[i] = true;
+					}
+				} );
+			}
+			if ( negativeCycle.empty() )
+				source = starting;
+			return negativeCycle.empty();
+		}
+
+		/**
+		 * @brief
+		 * Variant with Yen's ordering: an edge is forward when it goes to a
+		 vertex later in the order, backward otherwise. A round relaxes the
+		 forward edges sweeping the order front to back, then the backward
+		 edges back to front, so a round follows a path as far as it keeps
+		 its direction and ( size() + 1 ) / 2 rounds replace size() passes.
+		 The distances are the ones of run, on ties the predecessor may be
+		 another vertex on an equally short path.
+		 * @param starting
+		 * @param order
+		 * Every vertex once, or empty for 0, 1, 2, ...
+		 * @return
+		 * Returns false when negative cycles are found or the order is not
+		 a permutation of the vertices, and true otherwise.
+		*/
+		bool runYen( int starting = 0, std::vector<int> order = {} )
+		{
+			if ( !ready( starting ) )
+				return false;
+
+			if ( order.empty() )
+			{
+				order.resize( size() );
+				std::iota( order.begin(), order.end(), 0 );
+			}
+			std::vector<int> rank( size(), null );
+			if ( static_cast<int>( order.size() ) != size() )
+				return false;
+			bool identity = true;
+			for ( int r = 0; r < size(); r++ )
+			{
+				if ( order[r] < 0 || order[r] >= size() || rank[order[r]] != null )
+					return false;
+				rank[order[r]] = r;
+				identity = identity && order[r] == r;
+			}
+
+			std::fill_n( predecessor, size(), null );
+			std::fill_n( distance, size(), inf );
+			distance[starting] = 0;
+			source = null;
+
+			// The edges of every vertex with the forward ones first, so a
+			// sweep only looks at its own half of the edges
+			Graph parted{};
+			std::vector<int> split{};
+			if ( graph )
+			{
+				parted = *graph;
+				split.resize( size() );
+				for ( int j = 0; j < size(); j++ )
+				{
+					int e = parted.begin( j );
+					for ( int pass = 0; pass < 2; pass++ )
+					{
+						for ( int f = graph->begin( j ); f < graph->end( j ); f++ )
 						{
-							distance[i] = distance[j] + matrix[i + ( j * SIZE )];
-							predecessor[i] = j;
-							relaxations++;
+							if ( ( rank[graph->targets[f]] > rank[j] ) == ( pass == 0 ) )
+							{
+								parted.targets[e] = graph->targets[f];
+								parted.weights[e++] = graph->weights[f];
+							}
 						}
+						if ( pass == 0 )
+							split[j] = e;
 					}
 				}
+			}
+
+			// A shortest path has at most size() - 1 edges in runs of one
+			// direction. A round follows a forward and a backward run, the
+			// first round only the backward one when the path starts with
+			// it, so ( size() + 1 ) / 2 rounds find every shortest path and
+			// one more round that still relaxes proves a negative cycle
+			for ( int k = 0; k <= ( size() + 1 ) / 2; k++ )
+			{
+				int relaxations = 0;
+				for ( int r = 0; r < size(); r++ )
+					relaxations += sweep( order[r], rank, identity, parted, split, true );
+				for ( int r = size() - 1; r >= 0; r-- )
+					relaxations += sweep( order[r], rank, identity, parted, split, false );
+
 				// Stop when no more relaxation
-				if ( relaxations == 0 ) 
-					// There is no negative cycles 
+				if ( relaxations == 0 )
+				{
+					source = starting;
 					return true;
+				}
 			}
 			return false;
 		}
 
+		/**
+		 * @brief
+		 * Change the weight of one edge and repair the distances of the
+		 last run in place, instead of running again. A shorter edge
+		 spreads its gain from the vertex it enters, through the vertices
+		 whose distance gets shorter. A longer edge of the shortest path
+		 tree takes the subtree below it out, each vertex of the subtree
+		 gets the best distance its incoming edges from outside give, and
+		 those spread like a gain. Edges off the tree or to unreached
+		 vertices only get the new weight.
+		 * Negative Cycle : only a shorter edge can make one reachable. A
+		 cycle through the edge is found when the vertex the edge leaves
+		 gets a shorter distance, see getCycle. A cycle that was there all
+		 along behind vertices the edge makes reachable is found like in
+		 runQueue, by a path of size() edges, and is not kept.
+		 * @param from
+		 * @param to
+		 * @param weight
+		 * New cost of the edge from -> to, inf removes it from the matrix.
+		 A graph only takes new weights for edges it has, not inf.
+		 * @return
+		 * Returns false when the edge cannot be changed, when there are no
+		 distances to repair (no run, or a run or update that found a
+		 negative cycle, so run again), or when a negative cycle is found,
+		 and true otherwise. The weight is changed in the last two cases.
+		*/
+		bool update( int from, int to, int weight )
+		{
+			if ( to < 0 || to >= size() || !ready( from ) )
+				return false;
+
+			int old = inf;
+			if ( graph )
+			{
+				int e = edge( *graph, from, to );
+				if ( e == null || weight == inf )
+					return false;
+				if ( reversed.size() != size() )
+					reversed = graph->transpose();
+				old = graph->weights[e];
+				graph->weights[e] = weight;
+				reversed.weights[edge( reversed, to, from )] = weight;
+			}
+			else
+			{
+				old = matrix[to + ( from * size() )];
+				matrix[to + ( from * size() )] = weight;
+			}
+
+			if ( source == null )
+				return false;
+			if ( from == to || weight == old || distance[from] == inf )
+				return true;
+			negativeCycle.clear();
+
+			std::deque<int> changed{};
+			if ( weight < old )
+			{
+				if ( distance[from] + weight >= distance[to] )
+					return true;
+				distance[to] = distance[from] + weight;
+				predecessor[to] = from;
+				changed.push_back( to );
+			}
+			else
+			{
+				if ( predecessor[to] != from )
+					return true;
+
+				// The subtree of to, a child is entered by an edge of the tree
+				std::vector<int> subtree{ to };
+				for ( size_t s = 0; s < subtree.size(); s++ )
+				{
+					int j = subtree[s];
+					edgesFrom( j, [&]( int i, int )
+					{
+						if ( predecessor[i] == j )
+							subtree.push_back( i );
+					} );
+				}
+				for ( int v : subtree )
+				{
+					distance[v] = inf;
+					predecessor[v] = null;
+				}
+				for ( int v : subtree )
+				{
+					edgesTo( v, [&]( int j, int cost )
+					{
+						if ( distance[j] != inf && distance[j] + cost < distance[v] )
+						{
+							distance[v] = distance[j] + cost;
+							predecessor[v] = j;
+						}
+					} );
+					if ( distance[v] != inf )
+						changed.push_back( v );
+				}
+			}
+
+			if ( settle( changed, from ) )
+				return true;
+			source = null;
+			return false;
+		}
+
+		/**
+		 * @brief
+		 * The negative cycle found by the last runTree or update.
+		 * @return
+		 * Its vertices in the order of the edges, the last one has an edge
+		 back to the first. Empty when there was none.
+		*/
+		const std::vector<int>& getCycle() const
+		{
+			return negativeCycle;
+		}
+
 		/**
 		 * @brief 
 		 * Interpretation of the result that reconstructs the
@@ -167,14 +619,14 @@ namespace AI
 		*/
 		friend std::ostream& operator<<( std::ostream& os, const BellmanFord& rhs )
 		{
-			if ( !rhs.matrix )
+			if ( ( !rhs.matrix && !rhs.graph ) || !rhs.size() )
 			{
 				os << "[] []";
 				return os;
 			}
 
 			os << "[";
-			for ( int i = 0; i < SIZE - 1; i++ )
+			for ( int i = 0; i < rhs.size() - 1; i++ )
 			{
 				if ( rhs.distance[i] == inf )
 					os << "inf";
@@ -183,16 +635,16 @@ namespace AI
 				os << ",";
 			}
 
-			if ( rhs.distance[SIZE - 1] == inf )
+			if ( rhs.distance[rhs.size() - 1] == inf )
 				os << "inf";
 			else
-				os << rhs.distance[SIZE - 1];
+				os << rhs.distance[rhs.size() - 1];
 
 			os << "] ";
 
 			os << "[";
 
-			for ( int i = 0; i < SIZE - 1; i++ )
+			for ( int i = 0; i < rhs.size() - 1; i++ )
 			{
 				if ( rhs.predecessor[i] == null )
 					os << "null";
@@ -201,14 +653,448 @@ namespace AI
 				os << ",";
 			}
 
-			if ( rhs.predecessor[SIZE - 1] == null )
+			if ( rhs.predecessor[rhs.size() - 1] == null )
 				os << "null";
 			else
-				os << rhs.predecessor[SIZE - 1];
+				os << rhs.predecessor[rhs.size() - 1];
 
 			os << "]";
 			return os;
 		}
+
+		/**
+		 * @brief
+		 * Parallel variant: each pass is split over the destination
+		 vertices, every thread pulls the distances of its vertices from
+		 their incoming edges. A pass reads the distances of the previous
+		 one and the threads write disjoint ranges, so there are no write
+		 conflicts. Stops like run when a pass relaxes nothing, and reports
+		 the same negative cycles; on ties the predecessor may differ.
+		 * @param starting
+		 * @param threads
+		 * Threads of the pool that lives for this run, 1 for none.
+		 * @return
+		 * Returns false when negative cycles are found, and true otherwise.
+		*/
+		bool runParallel( int starting = 0, unsigned threads = std::thread::hardware_concurrency() )
+		{
+			if ( !ready( starting ) )
+				return false;
+
+			std::fill_n( predecessor, size(), null );
+			std::fill_n( distance, size(), inf );
+			distance[starting] = 0;
+			source = null;
+
+			Graph incoming = graph ? graph->transpose() : Graph{};
+			int count = static_cast<int>( std::min( std::max( threads, 1u ), static_cast<unsigned>( std::max( size(), 1 ) ) ) );
+
+			// Equal vertex ranges, or equal incoming edge counts when sparse
+			std::vector<int> bounds( count + 1, size() );
+			for ( int t = 0; t < count; t++ )
+			{
+				if ( graph )
+				{
+					long long edges = static_cast<long long>( incoming.edges() ) * t / count;
+					bounds[t] = static_cast<int>( std::lower_bound( incoming.offsets.begin(),
+						incoming.offsets.end() - 1, edges ) - incoming.offsets.begin() );
+				}
+				else
+					bounds[t] = static_cast<int>( static_cast<long long>( size() ) * t / count );
+			}
+
+			std::vector<int> next( distance, distance + size() );
+			std::vector<int> relaxations( count, 0 );
+			Barrier barrier( count );
+			bool done = false;		// written by thread 0 between the barriers
+			bool result = false;
+
+			auto work = [&]( int t )
+			{
+				for ( int k = 0; k < size(); k++ )
+				{
+					relaxations[t] = pull( incoming, next, bounds[t], bounds[t + 1] );
+					barrier.wait();
+
+					std::copy( next.begin() + bounds[t], next.begin() + bounds[t + 1], distance + bounds[t] );
+					if ( t == 0 )
+					{
+						int total = 0;
+						for ( int r : relaxations )
+							total += r;
+						// Stop when no more relaxation
+						done = result = ( total == 0 );
+					}
+					barrier.wait();
+
+					if ( done )
+						return;
+				}
+			};
+
+			std::vector<std::thread> workers{};
+			for ( int t = 1; t < count; t++ )
+				workers.emplace_back( work, t );
+			work( 0 );
+			for ( std::thread& worker : workers )
+				worker.join();
+
+			if ( result )
+				source = starting;
+			return result;
+		}
+
+	private:
+
+		void allocate()
+		{
+			if constexpr ( std::is_same<Storage, std::vector<int>>::value )
+			{
+				distances.assign( size(), inf );
+				predecessors.assign( size(), null );
+			}
+			else
+			{
+				distances.fill( inf );
+				predecessors.fill( null );
+			}
+			distance = distances.data();
+			predecessor = predecessors.data();
+		}
+
+		/**
+		 * @brief
+		 * Whether there is a graph to search from starting
+		 * @param starting
+		 * @return
+		 * true with a matrix, or a graph of size() vertices, and a starting
+		 vertex in it.
+		*/
+		bool ready( int starting ) const
+		{
+			if ( graph ? graph->size() != size() : !matrix )
+				return false;
+			return starting >= 0 && starting < size();
+		}
+
+		/**
+		 * @brief
+		 * Relax the vertices first to last - 1 from their incoming edges,
+		 reading distance and writing the new distances to next.
+		 * @param incoming
+		 * Transposed graph in sparse mode, unused with the matrix.
+		 * @param next
+		 * @param first
+		 * @param last
+		 * @return
+		 * Number of distances that got shorter.
+		*/
+		int pull( const Graph& incoming, std::vector<int>& next, int first, int last )
+		{
+			int relaxations = 0;
+			for ( int i = first; i < last; i++ )
+			{
+				int best = distance[i];
+				int from = predecessor[i];
+				if ( graph )
+				{
+					for ( int e = incoming.begin( i ); e < incoming.end( i ); e++ )
+					{
+						int j = incoming.targets[e];
+						if ( ( j != i ) && ( distance[j] != inf ) && ( distance[j] + incoming.weights[e] ) < best )
+						{
+							best = distance[j] + incoming.weights[e];
+							from = j;
+						}
+					}
+				}
+				else
+				{
+					for ( int j = 0; j < size(); j++ )
+					{
+						if ( ( j != i ) &&
+							 ( distance[j] != inf ) &&
+							 ( matrix[i + ( j * size() )] != inf ) &&
+							 ( distance[j] + matrix[i + ( j * size() )] ) < best )
+						{
+							best = distance[j] + matrix[i + ( j * size() )];
+							from = j;
+						}
+					}
+				}
+
+				next[i] = best;
+				if ( best < distance[i] )
+				{
+					predecessor[i] = from;
+					relaxations++;
+				}
+			}
+			return relaxations;
+		}
+
+		/**
+		 * @brief
+		 * Relax the forward or the backward edges leaving one vertex
+		 * @param j
+		 * @param rank
+		 * Position of every vertex in the order.
+		 * @param identity
+		 * Whether the order is 0, 1, 2, ..., so rank[i] is i.
+		 * @param parted
+		 * The graph with the forward edges of each vertex first, sparse only.
+		 * @param split
+		 * First backward edge of each vertex in parted, sparse only.
+		 * @param forward
+		 * @return
+		 * Number of distances that got shorter.
+		*/
+		int sweep( int j, const std::vector<int>& rank, bool identity, const Graph& parted,
+				   const std::vector<int>& split, bool forward )
+		{
+			if ( distance[j] == inf )
+				return 0;
+
+			int relaxations = 0;
+			if ( graph )
+			{
+				int first = forward ? parted.begin( j ) : split[j];
+				int last = forward ? split[j] : parted.end( j );
+				for ( int e = first; e < last; e++ )
+				{
+					int i = parted.targets[e];
+					if ( ( j != i ) && ( distance[j] + parted.weights[e] ) < distance[i] )
+					{
+						distance[i] = distance[j] + parted.weights[e];
+						predecessor[i] = j;
+						relaxations++;
+					}
+				}
+			}
+			else if ( identity )
+			{
+				// In index order the forward edges are right of the diagonal
+				const int* row = matrix + ( j * size() );
+				relaxations += forward
+					? relaxRow( row, distance[j], j, distance, predecessor, j + 1, size() )
+					: relaxRow( row, distance[j], j, distance, predecessor, 0, j );
+			}
+			else
+			{
+				edgesFrom( j, [&]( int i, int cost )
+				{
+					if ( ( rank[i] > rank[j] ) == forward && ( distance[j] + cost ) < distance[i] )
+					{
+						distance[i] = distance[j] + cost;
+						predecessor[i] = j;
+						relaxations++;
+					}
+				} );
+			}
+			return relaxations;
+		}
+
+		/**
+		 * @brief
+		 * Spread shorter distances from the given vertices, queue based
+		 like runQueue, for update.
+		 * @param changed
+		 * Vertices whose distance just got shorter.
+		 * @param from
+		 * Vertex the changed edge leaves: a shorter distance for it means
+		 a negative cycle through that edge, which goes to getCycle.
+		 * @return
+		 * Returns false when negative cycles are found, and true otherwise.
+		*/
+		bool settle( std::deque<int>& changed, int from )
+		{
+			pending.resize( size(), false );
+			lengths.resize( size(), 0 );
+			for ( int v : changed )
+			{
+				pending[v] = true;
+				lengths[v] = 0;
+			}
+
+			bool cycle = false;
+			while ( !changed.empty() && !cycle )
+			{
+				int j = changed.front();
+				changed.pop_front();
+				pending[j] = false;
+
+				edgesFrom( j, [&]( int i, int cost )
+				{
+					if ( cycle || distance[j] + cost >= distance[i] )
+						return;
+
+					if ( i == from )
+					{
+						// Without negative cycles no path to from uses the
+						// changed edge, so from never gets shorter. The tree
+						// path back from j to from closes the cycle when it
+						// runs through the edge
+						cycle = true;
+						std::vector<int> path{};
+						for ( int v = j; v != from && v != null && static_cast<int>( path.size() ) < size(); v = predecessor[v] )
+							path.push_back( v );
+						if ( static_cast<int>( path.size() ) < size() && predecessor[path.back()] == from )
+						{
+							negativeCycle.assign( path.rbegin(), path.rend() );
+							negativeCycle.insert( negativeCycle.begin(), from );
+						}
+						return;
+					}
+
+					distance[i] = distance[j] + cost;
+					predecessor[i] = j;
+					lengths[i] = lengths[j] + 1;
+					if ( lengths[i] >= size() )
+						cycle = true;
+					else if ( !pending[i] )
+					{
+						changed.push_back( i );
+						pending[i] = true;
+					}
+				} );
+			}
+
+			for ( int v : changed )
+				pending[v] = false;
+			return !cycle;
+		}
+
+		/**
+		 * @brief
+		 * Position of the edge j -> i in a graph, its rows are sorted
+		 * @param edges
+		 * @param j
+		 * @param i
+		 * @return
+		 * Index into targets and weights, null when there is no such edge.
+		*/
+		static int edge( const Graph& edges, int j, int i )
+		{
+			auto first = edges.targets.begin() + edges.begin( j );
+			auto last = edges.targets.begin() + edges.end( j );
+			auto it = std::lower_bound( first, last, i );
+			return ( it != last && *it == i ) ? static_cast<int>( it - edges.targets.begin() ) : null;
+		}
+
+		/**
+		 * @brief
+		 * Call visit( j, cost ) for every edge j -> i entering i, except
+		 self loops. Sparse mode reads the reversed graph of update.
+		 * @param i
+		 * @param visit
+		*/
+		template<typename Visit>
+		void edgesTo( int i, Visit visit ) const
+		{
+			if ( graph )
+			{
+				for ( int e = reversed.begin( i ); e < reversed.end( i ); e++ )
+					if ( reversed.targets[e] != i )
+						visit( reversed.targets[e], reversed.weights[e] );
+				return;
+			}
+
+			for ( int j = 0; j < size(); j++ )
+				if ( ( j != i ) && ( matrix[i + ( j * size() )] != inf ) )
+					visit( j, matrix[i + ( j * size() )] );
+		}
+
+		/**
+		 * @brief
+		 * Call visit( i, cost ) for every edge j -> i of the matrix or the
+		 graph, except self loops.
+		 * @param j
+		 * Vertex the edges leave.
+		 * @param visit
+		*/
+		template<typename Visit>
+		void edgesFrom( int j, Visit visit ) const
+		{
+			if ( graph )
+			{
+				for ( int e = graph->begin( j ); e < graph->end( j ); e++ )
+					if ( graph->targets[e] != j )
+						visit( graph->targets[e], graph->weights[e] );
+				return;
+			}
+
+			for ( int i = 0; i < size(); i++ )
+				if ( ( j != i ) && ( matrix[i + ( j * size() )] != inf ) )
+					visit( i, matrix[i + ( j * size() )] );
+		}
+
+		/**
+		 * @brief
+		 * One pass over every entry of the cost matrix, a row at a time.
+		 The diagonal is left out by relaxing the row in two pieces. Tiny
+		 compile-time sizes relax inline, the loops have constant bounds
+		 the compiler unrolls.
+		 * @return
+		 * Number of distances that got shorter.
+		*/
+		int relaxDense()
+		{
+			int relaxations = 0;
+			if constexpr ( SIZE > 0 && SIZE <= UNROLL )
+			{
+				for ( int j = 0; j < SIZE; j++ )
+				{
+					if ( distance[j] == inf )
+						continue;
+
+					int d = distance[j];
+					for ( int i = 0; i < SIZE; i++ )
+						if ( j != i )
+							relaxations += relaxEntry( matrix[i + ( j * SIZE )], d, j, distance[i], predecessor[i] );
+				}
+				return relaxations;
+			}
+
+			for ( int j = 0; j < size(); j++ )
+			{
+				if ( distance[j] == inf )
+					continue;
+
+				const int* row = matrix + ( j * size() );
+				relaxations += relaxRow( row, distance[j], j, distance, predecessor, 0, j );
+				relaxations += relaxRow( row, distance[j], j, distance, predecessor, j + 1, size() );
+			}
+			return relaxations;
+		}
+
+		/**
+		 * @brief
+		 * One pass over the edges of the graph, in the order of relaxDense.
+		 Self loops are skipped like the diagonal of the matrix.
+		 * @return
+		 * Number of distances that got shorter.
+		*/
+		int relaxSparse()
+		{
+			int relaxations = 0;
+			for ( int j = 0; j < size(); j++ )
+			{
+				if ( distance[j] == inf )
+					continue;
+
+				for ( int e = graph->begin( j ); e < graph->end( j ); e++ )
+				{
+					int i = graph->targets[e];
+					if ( ( j != i ) && ( distance[j] + graph->weights[e] ) < distance[i] )
+					{
+						distance[i] = distance[j] + graph->weights[e];
+						predecessor[i] = j;
+						relaxations++;
+					}
+				}
+			}
+			return relaxations;
+		}
 	};
 } // end namespace
 
@@ -16,10 +16,18 @@ void test7();
 void test8();
 void test9();
 void test10();
+void test11();
+void test12();
+void test13();
+void test14();
+void test15();
+void test16();
+void test17();
+void test18();
 
 int main(int argc, char* argv[])
 {
-    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10 };
+    void (*f[])() = { test1, test2, test3, test4, test5, test6, test7, test8, test9, test10, test11, test12, test13, test14, test15, test16, test17, test18 };
     const int SIZE = sizeof(f) / sizeof(f[0]);
     int id = -1;
 
@@ -375,3 +383,466 @@ void test10()
     else
         std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
 }
+
+// Sparse mode, from an edge list and from a cost matrix
+
+void test11()
+{
+    const int inf = AI::inf;
+
+    int matrix[] = {
+        0,   10,  inf, inf, inf,
+        10 , 0,   20,  inf, inf,
+        inf, 20,  0,   30,  inf,
+        inf, inf, 30,  0,   40,
+        inf, inf, inf, 40,  0
+    };
+
+    AI::BellmanFord<5> dense(matrix);
+    dense.run(2);
+
+    AI::Graph fromMatrix = AI::Graph::fromMatrix(matrix, 5);
+    AI::BellmanFord<5> sparse(&fromMatrix);
+    sparse.run(2);
+
+    // Out of order, with a parallel edge, a self loop and an unknown vertex
+    AI::Graph fromEdges = AI::Graph::fromEdges(5, {
+        {3, 4, 40}, {2, 3, 30}, {0, 1, 10}, {1, 0, 10}, {1, 2, 20}, {2, 1, 20},
+        {3, 2, 30}, {4, 3, 40}, {2, 1, 25}, {4, 4, -5}, {4, 7, 1}
+    });
+    AI::BellmanFord<5> edges(&fromEdges);
+    edges.run(2);
+
+    std::ostringstream os;
+    os << dense << ' ' << sparse << ' ' << edges << ' ' << fromEdges.edges() << ' '
+       << edges.getPath(4) << ' ' << edges.getRoute(0);
+
+    int cycle[] = {
+        0,   10,  inf, inf, inf,
+        inf, 0,   20,  inf, inf,
+        inf, inf, 0,   30,  inf,
+        inf, -90, inf, 0,   40,
+        inf, inf, inf, inf, 0
+    };
+    AI::Graph negative = AI::Graph::fromMatrix(cycle, 5);
+    AI::BellmanFord<5> cycleSparse(&negative);
+    os << ' ' << cycleSparse.run(0);
+
+    std::string actual = os.str();
+    std::string expected = "[30,20,0,30,70] [1,2,null,2,3] [30,20,0,30,70] [1,2,null,2,3] "
+                           "[30,20,0,30,70] [1,2,null,2,3] 9 3,4 [2,1,20][1,0,10] 0";
+
+    std::cout << "Test 11 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Queue based relaxation (SPFA) and the negative cycle check
+
+void test12()
+{
+    const int inf = AI::inf;
+
+    int matrix[] = {
+        0,   10,  inf, inf, inf,
+        10 , 0,   20,  inf, inf,
+        inf, 20,  0,   30,  inf,
+        inf, inf, 30,  0,   40,
+        inf, inf, inf, 40,  0
+    };
+
+    AI::BellmanFord<5> dense(matrix);
+    bool denseResult = dense.runQueue(2);
+
+    AI::Graph graph = AI::Graph::fromMatrix(matrix, 5);
+    AI::BellmanFord<5> sparse(&graph);
+    bool sparseResult = sparse.runQueue(2);
+
+    std::ostringstream os;
+    os << denseResult << ' ' << dense << ' ' << sparseResult << ' ' << sparse << ' ';
+
+    // A chain against the index order takes all SIZE - 1 passes
+    int chain[] = {
+        0,   inf, inf, inf, inf,
+        -1,  0,   inf, inf, inf,
+        inf, -2,  0,   inf, inf,
+        inf, inf, -3,  0,   inf,
+        inf, inf, inf, -4,  0
+    };
+
+    AI::BellmanFord<5> classic(chain);
+    AI::BellmanFord<5> queue(chain);
+    os << classic.run(4) << queue.runQueue(4) << ' ' << classic << ' ' << queue << ' ';
+
+    int cycle[] = {
+        0,   10,  inf, inf, inf,
+        inf, 0,   20,  inf, inf,
+        inf, inf, 0,   30,  inf,
+        inf, -90, inf, 0,   40,
+        inf, inf, inf, inf, 0
+    };
+
+    AI::BellmanFord<5> negative(cycle);
+    os << negative.run(0) << negative.runQueue(0) << negative.runQueue(4);
+
+    std::string actual = os.str();
+    std::string expected = "1 [30,20,0,30,70] [1,2,null,2,3] 1 [30,20,0,30,70] [1,2,null,2,3] "
+                           "11 [-10,-9,-7,-4,0] [1,2,3,4,null] [-10,-9,-7,-4,0] [1,2,3,4,null] 001";
+
+    std::cout << "Test 12 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Relaxation passes split over threads
+
+void test13()
+{
+    const int inf = AI::inf;
+
+    int matrix[] = {
+        0,   10,  inf, inf, inf,
+        10 , 0,   20,  inf, inf,
+        inf, 20,  0,   30,  inf,
+        inf, inf, 30,  0,   40,
+        inf, inf, inf, 40,  0
+    };
+
+    AI::BellmanFord<5> dense(matrix);
+    bool denseResult = dense.runParallel(2, 3);
+
+    AI::Graph graph = AI::Graph::fromMatrix(matrix, 5);
+    AI::BellmanFord<5> sparse(&graph);
+    bool sparseResult = sparse.runParallel(2, 2);
+
+    std::ostringstream os;
+    os << denseResult << ' ' << dense << ' ' << sparseResult << ' ' << sparse << ' ';
+
+    // A ring of 500 vertices with chords, against the sequential result.
+    // Costs c + p(from) - p(to) with c >= 0 are often negative, yet every
+    // cycle costs the sum of its c
+    const int SIZE = 500;
+    auto p = [](int v) { return v * 13 % 29; };
+    std::vector<std::array<int, 3>> edges;
+    for (int j = 0; j < SIZE; ++j)
+    {
+        int chord = (j * 37 + 11) % SIZE, back = (j * 17 + 3) % SIZE;
+        edges.push_back({ j, (j + 1) % SIZE, 7 + j % 5 + p(j) - p((j + 1) % SIZE) });
+        edges.push_back({ j, chord, 50 + j % 13 + p(j) - p(chord) });
+        edges.push_back({ back, j, j % 7 + p(back) - p(j) });
+    }
+    AI::Graph ring = AI::Graph::fromEdges(SIZE, edges);
+
+    AI::BellmanFord<SIZE> sequential(&ring);
+    AI::BellmanFord<SIZE> parallel(&ring);
+    bool same = sequential.run(0) == parallel.runParallel(0, 4);
+    same = same && std::equal(sequential.distance, sequential.distance + SIZE, parallel.distance);
+    os << same << ' ';
+
+    int cycle[] = {
+        0,   10,  inf, inf, inf,
+        inf, 0,   20,  inf, inf,
+        inf, inf, 0,   30,  inf,
+        inf, -90, inf, 0,   40,
+        inf, inf, inf, inf, 0
+    };
+
+    AI::BellmanFord<5> negative(cycle);
+    os << negative.runParallel(0, 4) << negative.runParallel(4, 4) << negative.runParallel(0, 1);
+
+    std::string actual = os.str();
+    std::string expected = "1 [30,20,0,30,70] [1,2,null,2,3] 1 [30,20,0,30,70] [1,2,null,2,3] 1 010";
+
+    std::cout << "Test 13 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Branchless row kernel, longer than a vector so the tail is used too
+
+void test14()
+{
+    const int inf = AI::inf;
+
+    int row[]         = { 5, inf, -3,  0, inf, 7, 2,   inf, 1, 100, -10 };
+    int distance[]    = { 0, inf, inf, -4, 10, 3, inf, -20, 0, 96,  5 };
+    int predecessor[] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+
+    int relaxations = AI::relaxRow(row, -4, 99, distance, predecessor, 0, 11);
+
+    std::ostringstream os;
+    os << relaxations << " [";
+    for (int i = 0; i < 11; ++i)
+        os << (distance[i] == inf ? "inf" : std::to_string(distance[i])) << (i < 10 ? "," : "] [");
+    for (int i = 0; i < 11; ++i)
+        os << predecessor[i] << (i < 10 ? "," : "]");
+
+    // Only the given range is touched
+    os << ' ' << AI::relaxRow(row, -100, 7, distance, predecessor, 3, 3) << ' ' << distance[3];
+
+    std::string actual = os.str();
+    std::string expected = "4 [0,inf,-7,-4,10,3,-2,-20,-3,96,-14] [-1,-1,99,-1,-1,-1,99,-1,99,-1,99] 0 -4";
+
+    std::cout << "Test 14 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Sizes known at run time, graphs read from text and inline storage
+
+void test15()
+{
+    const int inf = AI::inf;
+
+    int matrix[] = {
+        0,   10,  inf, inf, inf,
+        10 , 0,   20,  inf, inf,
+        inf, 20,  0,   30,  inf,
+        inf, inf, 30,  0,   40,
+        inf, inf, inf, 40,  0
+    };
+
+    AI::BellmanFord<> fromMatrix(matrix, 5);
+    fromMatrix.run(2);
+
+    std::istringstream plain("# the graph of test 4\n5\n0 1 10\n1 0 10\n1 2 20\n2 1 20\n"
+                             "2 3 30\n3 2 30\n3 4 40\n4 3 40\n");
+    AI::Graph graph;
+    bool read = AI::Graph::read(plain, graph);
+    AI::BellmanFord<> fromText(&graph);
+    fromText.run(2);
+
+    std::ostringstream os;
+    os << fromMatrix << ' ' << read << fromText.size() << ' ' << fromText << ' ';
+
+    std::istringstream dimacs("c three vertices\np sp 3 2\na 1 2 5\na 2 3 -2\n");
+    AI::Graph small;
+    read = AI::Graph::read(dimacs, small);
+    AI::BellmanFord<> fromDimacs(&small);
+    os << read << fromDimacs.run(0) << ' ' << fromDimacs << ' ';
+
+    std::istringstream broken("5\n0 1\n");
+    std::istringstream truncated("p sp\n");
+    os << AI::Graph::read(broken, small) << AI::Graph::read(truncated, small) << small.size() << ' ';
+
+    // Out of range starting vertices are refused
+    os << fromText.run(5) << fromText.run(-1) << ' ';
+
+    // Small sizes keep the arrays in the object, large ones on the heap
+    os << (sizeof(AI::BellmanFord<64>) >= 2 * 64 * sizeof(int))
+       << (sizeof(AI::BellmanFord<1000>) < 1000 * sizeof(int));
+
+    std::string actual = os.str();
+    std::string expected = "[30,20,0,30,70] [1,2,null,2,3] 15 [30,20,0,30,70] [1,2,null,2,3] "
+                           "11 [0,5,3] [null,0,1] 003 00 11";
+
+    std::cout << "Test 15 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Negative cycles found by subtree disassembly as soon as they form
+
+void test16()
+{
+    const int inf = AI::inf;
+
+    int cycle[] = {
+        0,   10,  inf, inf, inf,
+        inf, 0,   20,  inf, inf,
+        inf, inf, 0,   30,  inf,
+        inf, -90, inf, 0,   40,
+        inf, inf, inf, inf, 0
+    };
+
+    AI::BellmanFord<5> negative(cycle);
+
+    std::ostringstream os;
+    os << negative.runTree(0) << ' ' << negative.getCycle() << ' ';
+    os << negative.runTree(4) << negative.getCycle().size() << ' ';
+
+    int matrix[] = {
+        0,   10,  inf, inf, inf,
+        10 , 0,   20,  inf, inf,
+        inf, 20,  0,   30,  inf,
+        inf, inf, 30,  0,   40,
+        inf, inf, inf, 40,  0
+    };
+
+    AI::Graph graph = AI::Graph::fromMatrix(matrix, 5);
+    AI::BellmanFord<> positive(&graph);
+    os << positive.runTree(2) << ' ' << positive << ' ';
+
+    // A cycle through the starting vertex, found on the sparse graph
+    AI::Graph loop = AI::Graph::fromEdges(4, { {0, 1, 1}, {1, 2, 1}, {2, 0, -3}, {2, 3, 1} });
+    AI::BellmanFord<> sparse(&loop);
+    os << sparse.runTree(0) << ' ' << sparse.getCycle();
+
+    std::string actual = os.str();
+    std::string expected = "0 1,2,3 10 1 [30,20,0,30,70] [1,2,null,2,3] 0 0,1,2";
+
+    std::cout << "Test 16 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Yen's ordering: forward and backward sweeps over a vertex order
+
+void test17()
+{
+    const int inf = AI::inf;
+
+    int matrix[] = {
+        0,   10,  inf, inf, inf,
+        10 , 0,   20,  inf, inf,
+        inf, 20,  0,   30,  inf,
+        inf, inf, 30,  0,   40,
+        inf, inf, inf, 40,  0
+    };
+
+    AI::BellmanFord<5> dense(matrix);
+    bool denseResult = dense.runYen(2);
+
+    AI::Graph graph = AI::Graph::fromMatrix(matrix, 5);
+    AI::BellmanFord<5> sparse(&graph);
+    bool sparseResult = sparse.runYen(2);
+
+    std::ostringstream os;
+    os << denseResult << ' ' << dense << ' ' << sparseResult << ' ' << sparse << ' ';
+
+    // The chain against the index order is done by the first backward sweep,
+    // and in its own order by the first forward sweep
+    int chain[] = {
+        0,   inf, inf, inf, inf,
+        -1,  0,   inf, inf, inf,
+        inf, -2,  0,   inf, inf,
+        inf, inf, -3,  0,   inf,
+        inf, inf, inf, -4,  0
+    };
+
+    AI::BellmanFord<5> indexOrder(chain);
+    AI::BellmanFord<5> chainOrder(chain);
+    os << indexOrder.runYen(4) << chainOrder.runYen(4, { 4, 3, 2, 1, 0 }) << ' '
+       << indexOrder << ' ' << chainOrder << ' ';
+
+    int cycle[] = {
+        0,   10,  inf, inf, inf,
+        inf, 0,   20,  inf, inf,
+        inf, inf, 0,   30,  inf,
+        inf, -90, inf, 0,   40,
+        inf, inf, inf, inf, 0
+    };
+
+    AI::BellmanFord<5> negative(cycle);
+    AI::Graph negativeGraph = AI::Graph::fromMatrix(cycle, 5);
+    AI::BellmanFord<5> negativeSparse(&negativeGraph);
+    os << negative.runYen(0) << negativeSparse.runYen(0, { 3, 1, 4, 0, 2 }) << negative.runYen(4);
+
+    // An order that is not a permutation of the vertices is refused
+    os << ' ' << dense.runYen(2, { 0, 0, 1, 2, 3 }) << dense.runYen(2, { 0, 1, 2 }) << ' ';
+
+    // An odd count of vertices and a path that starts backward take
+    // ( SIZE + 1 ) / 2 rounds before the check
+    int odd[] = {
+        0,   1,   inf,
+        inf, 0,   inf,
+        1,   inf, 0
+    };
+
+    AI::BellmanFord<3> oddDense(odd);
+    AI::Graph oddGraph = AI::Graph::fromMatrix(odd, 3);
+    AI::BellmanFord<3> oddSparse(&oddGraph);
+    os << oddDense.runYen(2) << oddSparse.runYen(2) << ' ' << oddDense << ' ';
+
+    // Vertex 1 keeps its place in the order, yet 1 -> 2 goes backward
+    int fixed[] = {
+        0,   5,   inf, inf,
+        inf, 0,   8,   inf,
+        inf, inf, 0,   7,
+        inf, inf, inf, 0
+    };
+
+    AI::BellmanFord<4> fixedPoint(fixed);
+    os << fixedPoint.runYen(0, { 2, 1, 3, 0 }) << ' ' << fixedPoint;
+
+    std::string actual = os.str();
+    std::string expected = "1 [30,20,0,30,70] [1,2,null,2,3] 1 [30,20,0,30,70] [1,2,null,2,3] "
+                           "11 [-10,-9,-7,-4,0] [1,2,3,4,null] [-10,-9,-7,-4,0] [1,2,3,4,null] 001 00 "
+                           "11 [1,2,0] [2,0,null] 1 [0,5,13,20] [null,0,1,2]";
+
+    std::cout << "Test 17 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}
+
+// Single edge updates repaired in place
+
+void test18()
+{
+    const int inf = AI::inf;
+
+    int matrix[] = {
+        0,   10,  inf, inf, inf,
+        10 , 0,   20,  inf, inf,
+        inf, 20,  0,   30,  inf,
+        inf, inf, 30,  0,   40,
+        inf, inf, inf, 40,  0
+    };
+
+    AI::BellmanFord<5> dense(matrix);
+
+    // Nothing to repair before a run, the weight is changed all the same
+    std::ostringstream os;
+    os << dense.update(0, 1, 5) << matrix[1] << ' ';
+    matrix[1] = 10;
+
+    dense.run(2);
+    os << dense.update(2, 4, 50) << ' ' << dense << ' ';  // new edge
+    os << dense.update(2, 1, 45) << ' ' << dense << ' ';  // longer tree edge
+    os << dense.update(2, 3, 1) << ' ' << dense << ' ';   // shorter tree edge
+    os << dense.update(0, 1, 90) << ' ' << dense << ' ';  // off the tree
+
+    // Closes 2 -> 3 -> 4 -> 2, after that there is nothing to repair
+    os << dense.update(4, 2, -50) << ' ' << dense.getCycle() << ' ' << dense.update(0, 1, 5) << ' ';
+
+    int edges[] = {
+        0,   10,  inf, inf, inf,
+        10 , 0,   20,  inf, inf,
+        inf, 20,  0,   30,  inf,
+        inf, inf, 30,  0,   40,
+        inf, inf, inf, 40,  0
+    };
+
+    AI::Graph graph = AI::Graph::fromMatrix(edges, 5);
+    AI::BellmanFord<> sparse(&graph);
+    sparse.run(2);
+    os << sparse.update(3, 4, 10) << sparse.update(1, 0, 50) << ' ' << sparse << ' ';
+
+    // A graph has no room for new edges, and keeps its distances
+    os << sparse.update(0, 4, 1) << sparse.update(3, 4, inf) << sparse.update(3, 4, 20) << ' ' << sparse;
+
+    std::string actual = os.str();
+    std::string expected = "05 1 [30,20,0,30,50] [1,2,null,2,2] 1 [55,45,0,30,50] [1,2,null,2,2] "
+                           "1 [55,45,0,1,41] [1,2,null,2,3] 1 [55,45,0,1,41] [1,2,null,2,3] "
+                           "0 4,2,3 0 11 [70,20,0,30,40] [1,2,null,2,3] 001 [70,20,0,30,50] [1,2,null,2,3]";
+
+    std::cout << "Test 18 : ";
+    if (actual == expected)
+        std::cout << "Pass" << std::endl;
+    else
+        std::cout << "Failed (" << std::endl << actual << ')' << std::endl;
+}